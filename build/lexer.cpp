@@ -0,0 +1,250 @@
+// test-only hand-written stand-in for flex output of src/lexer.l
+istream* _lexerIStream = nullptr;
+size_t   _lexerLineNo  = 0;
+static string _lxBuf;
+static size_t _lxPos = 0;
+static int _lxState = 0; // 0:N 1:C 2:I
+enum { LN = 1, LC = 2, LI = 4 };
+
+struct LxRule { int states; regex re; int id; };
+
+static vector<LxRule>& lxRules() {
+	static vector<LxRule> rules;
+	if( rules.empty() ) {
+		auto add = [&]( int st, char const* re ) { rules.push_back( LxRule{ st, regex( re ), int( rules.size() ) } ); };
+		add( LN|LI, "\\(" ); //0
+		add( LN|LI, "\\[" );
+		add( LN|LC|LI, "\\)" );
+		add( LN|LC|LI, "\\]" );
+		add( LN|LI, "\\{" );
+		add( LN|LI, "\\}" ); //5
+		add( LN|LI, ";" );
+		add( LN|LI, ":" );
+		add( LN|LI, "&" );
+		add( LN|LI, "!" );
+		add( LN|LI, "\\|" ); //10
+		add( LN|LI, "=" );
+		add( LN|LI, "\\^" );
+		add( LN|LI, "\\$" );
+		add( LN|LI, "&&" );
+		add( LN|LI, "\\|\\|" ); //15
+		add( LN|LI, "->" );
+		add( LN|LI, ">\\|" );
+		add( LN|LI, "\\|>" );
+		add( LN|LI, "\\|>>" );
+		add( LN|LI, "~" ); //20
+		add( LN|LI, "\\+" );
+		add( LN|LI, "-" );
+		add( LN|LI, "\\*" );
+		add( LN|LI, "/" );
+		add( LN|LI, "%" ); //25
+		add( LN|LI, "<" );
+		add( LN|LI, ">" );
+		add( LN|LI, "==" );
+		add( LN|LI, "!=" );
+		add( LN|LI, "<=" ); //30
+		add( LN|LI, ">=" );
+		add( LN|LI, "if" );
+		add( LN|LI, "else" );
+		add( LN|LI, "\\n[ \\t]*else" );
+		add( LN|LI, "while" ); //35
+		add( LN|LI, "break" );
+		add( LN|LI, "return" );
+		add( LN|LI, "let" );
+		add( LN|LI, "let!" );
+		add( LN|LI, "fun" ); //40
+		add( LN|LI, "fetch" );
+		add( LN|LI, "fetch!" );
+		add( LN|LI, "yield" );
+		add( LN|LI, "zip" );
+		add( LN|LI, "defer" ); //45
+		add( LN|LI, "chdir" );
+		add( LN|LI, "\\$[a-zA-Z0-9_]+" );
+		add( LN|LI, "#[a-zA-Z0-9_]+" );
+		add( LN|LI, "\\$[a-zA-Z0-9_]+\\(" );
+		add( LN|LI, "[^~()\\[\\]$\" \\t\\n]([^()\\[\\]$\" \\t\\n]|\\[[^()\\[\\]$\" \\t\\n/]+\\])*" ); //50
+		add( LN|LI, "\"(\\\\[\\s\\S]|[^\\\\\"])*\"" );
+		add( LC, "[^\\)\\] \\t\\n]" );
+		add( LI, "[ \\t]+" );
+		add( LN|LC, "[ \\t]+" );
+		add( LI, "\\n" ); //55
+		add( LN|LC, "\\n" );
+		add( LI, "//[^\\n]*" );
+		add( LN|LC, "//[^\\n]*" );
+	}
+	return rules;
+}
+
+int yylex() {
+	static int const codes[] = {
+		'(', '[', ')', ']', '{', '}', ';', ':', '&', '!', '|', '=', '^', '$',
+		TK_AND2, TK_OR2, TK_ARROW, TK_RDFR, TK_RDT1, TK_RDT2,
+		'~', '+', '-', '*', '/', '%', '<', '>', TK_EQ, TK_NE, TK_LE, TK_GE,
+		TK_IF, TK_ELSE, TK_ELSE, TK_WHILE, TK_BREAK, TK_RETURN, TK_LET, TK_LETBANG,
+		TK_FUN, TK_FETCH, TK_FETCHBANG, TK_YIELD, TK_ZIP, TK_DEFER, TK_CHDIR,
+	};
+	static int const next[] = {
+		2, 2, 1, 1, 2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	};
+	while( true ) {
+		if( _lxPos >= _lxBuf.size() ) {
+			return 0;
+		}
+		int best = -1;
+		size_t bestLen = 0;
+		for( auto& r: lxRules() ) {
+			if( !(r.states & (1 << _lxState)) ) {
+				continue;
+			}
+			smatch m;
+			if( regex_search( _lxBuf.cbegin() + _lxPos, _lxBuf.cend(), m, r.re, regex_constants::match_continuous ) ) {
+				size_t len = m.length( 0 );
+				if( len > bestLen ) {
+					best = r.id;
+					bestLen = len;
+				}
+			}
+		}
+		if( best < 0 ) {
+			// flex default: echo
+			++_lxPos;
+			continue;
+		}
+		char const* yytext = _lxBuf.data() + _lxPos;
+		int yyleng = bestLen;
+		_lxPos += bestLen;
+		if( best <= 46 ) {
+			if( best == 34 ) {
+				++_lexerLineNo;
+			}
+			_lxState = next[best];
+			return codes[best];
+		}
+		switch( best ) {
+			case 47:
+				yylval.var = new ast::Var( string( yytext + 1, yyleng - 1 ), _lexerLineNo );
+				_lxState = 1;
+				return TK_VAR;
+			case 48:
+				yylval.var = new ast::Var( string( yytext + 1, yyleng - 1 ), _lexerLineNo );
+				_lxState = 1;
+				return TK_SIZE;
+			case 49:
+				yylval.var = new ast::Var( string( yytext + 1, yyleng - 2 ), _lexerLineNo );
+				_lxState = 2;
+				return TK_INDEX;
+			case 50: {
+				string yystr( yytext, yyleng );
+				char const* yytext = yystr.c_str();
+				#define yyless( n ) (_lxPos -= yyleng - (n), yyleng = (n))
+				
+	// a bracket expression without blanks is a character class only in a
+	// word which also has "*" or "?", e.g. "*[pwd]" matches the names which
+	// end with p, w or d.  otherwise the bracket starts a substitution as
+	// before; a word can't start with a bracket, so "[ab]*" is the output of
+	// "ab" followed by "*".  a glob is concatenated with a substitution
+	// through a variable: "let $d = [pwd]" and then "*$d".
+	char const* bracket = strchr( yytext, '[' );
+	if( bracket != nullptr && strpbrk( yytext, "*?" ) == nullptr ) {
+		yyless( bracket - yytext );
+	}
+
+	MetaString w;
+	w.reserve( yyleng );
+	bool cls = false;
+	for( int i = 0; i < yyleng; ++i ) {
+		char c = yytext[i];
+		if( cls ) {
+			cls = c != ']';
+			w.push_back( c, !cls );
+		}
+		else {
+			cls = c == '[';
+			w.push_back( c, c == '*' || c == '?' || cls );
+		}
+	}
+
+	yylval.word = new ast::Word( move( w ) );
+				#undef yyless
+				_lxState = 1;
+				return TK_WORD;
+			}
+			case 51: {
+				
+	MetaString w;
+	w.reserve( yyleng );
+	for( int i = 1; i < yyleng - 1; ++i ) {
+		char c;
+		if( yytext[i] == '\\' ) {
+			++i;
+			assert( yytext[i] != '\0' );
+			if( isalnum( yytext[i] ) ) {
+				switch( yytext[i] ) {
+					case '0': c = '\0';   break;
+					case 'a': c = '\a';   break;
+					case 'b': c = '\b';   break;
+					case 'f': c = '\f';   break;
+					case 'n': c = '\n';   break;
+					case 'r': c = '\r';   break;
+					case 't': c = '\t';   break;
+					case 'v': c = '\v';   break;
+					case 'e': c = '\x1b'; break;
+					default:
+						throw SyntaxError( _lexerLineNo );
+				}
+			}
+			else {
+				c = yytext[i];
+			}
+		}
+		else {
+			c = yytext[i];
+		}
+		w.push_back( c );
+	}
+
+	yylval.word = new ast::Word( move( w ) );
+				_lxState = 0;
+				return TK_WORD;
+			}
+			case 52:
+				_lxPos -= bestLen;
+				_lxState = 0;
+				return '^';
+			case 53:
+				break;
+			case 54:
+				_lxState = 0;
+				break;
+			case 55:
+				++_lexerLineNo;
+				break;
+			case 56:
+				_lxState = 0;
+				++_lexerLineNo;
+				return ';';
+			case 57:
+				break;
+			case 58:
+				_lxState = 0;
+				break;
+		}
+	}
+}
+
+void lexerInit( istream* istr ) {
+	_lexerIStream = istr;
+	_lexerLineNo  = 0;
+	_lxState = 0;
+	_lxPos = 0;
+	_lxBuf.clear();
+	if( istr ) {
+		_lxBuf.assign( istreambuf_iterator<char>( *istr ), istreambuf_iterator<char>() );
+	}
+}
+
+size_t lexerLineNo() {
+	return _lexerLineNo;
+}
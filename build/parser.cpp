@@ -0,0 +1,2154 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 3 "src/parser.y"
+
+	template<class T>
+	struct StupidPtr {
+		StupidPtr& operator=( T* p ) {
+			_ptr = p;
+			return *this;
+		}
+
+		template<class U>
+		operator StupidPtr<U>() const {
+			StupidPtr<U> dst;
+			dst._ptr = _ptr;
+			return dst;
+		}
+
+		template<class U>
+		operator unique_ptr<U>() const {
+			return unique_ptr<U>( _ptr );
+		}
+
+		private:
+			T* _ptr;
+		
+		template<class U> friend struct StupidPtr;
+	};
+
+	int yylex();
+	[[noreturn]] int yyerror( char const* );
+
+	unique_ptr<ast::Stmt> _parserResult;
+
+	using namespace ast;
+
+#line 105 "build/parser.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    TK_AND2 = 258,                 /* TK_AND2  */
+    TK_OR2 = 259,                  /* TK_OR2  */
+    TK_RDT1 = 260,                 /* TK_RDT1  */
+    TK_RDT2 = 261,                 /* TK_RDT2  */
+    TK_RDFR = 262,                 /* TK_RDFR  */
+    TK_WORD = 263,                 /* TK_WORD  */
+    TK_VAR = 264,                  /* TK_VAR  */
+    TK_IF = 265,                   /* TK_IF  */
+    TK_ELSE = 266,                 /* TK_ELSE  */
+    TK_WHILE = 267,                /* TK_WHILE  */
+    TK_BREAK = 268,                /* TK_BREAK  */
+    TK_RETURN = 269,               /* TK_RETURN  */
+    TK_LET = 270,                  /* TK_LET  */
+    TK_FUN = 271,                  /* TK_FUN  */
+    TK_WHEN = 272,                 /* TK_WHEN  */
+    TK_FETCH = 273,                /* TK_FETCH  */
+    TK_YIELD = 274,                /* TK_YIELD  */
+    TK_DEFER = 275,                /* TK_DEFER  */
+    TK_FOR = 276,                  /* TK_FOR  */
+    TK_ZIP = 277,                  /* TK_ZIP  */
+    TK_CHDIR = 278,                /* TK_CHDIR  */
+    TK_ARROW = 279,                /* TK_ARROW  */
+    TK_EQ = 280,                   /* TK_EQ  */
+    TK_NE = 281,                   /* TK_NE  */
+    TK_LE = 282,                   /* TK_LE  */
+    TK_GE = 283,                   /* TK_GE  */
+    TK_INDEX = 284,                /* TK_INDEX  */
+    TK_SIZE = 285,                 /* TK_SIZE  */
+    TK_LETBANG = 286,              /* TK_LETBANG  */
+    TK_FETCHBANG = 287             /* TK_FETCHBANG  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define TK_AND2 258
+#define TK_OR2 259
+#define TK_RDT1 260
+#define TK_RDT2 261
+#define TK_RDFR 262
+#define TK_WORD 263
+#define TK_VAR 264
+#define TK_IF 265
+#define TK_ELSE 266
+#define TK_WHILE 267
+#define TK_BREAK 268
+#define TK_RETURN 269
+#define TK_LET 270
+#define TK_FUN 271
+#define TK_WHEN 272
+#define TK_FETCH 273
+#define TK_YIELD 274
+#define TK_DEFER 275
+#define TK_FOR 276
+#define TK_ZIP 277
+#define TK_CHDIR 278
+#define TK_ARROW 279
+#define TK_EQ 280
+#define TK_NE 281
+#define TK_LE 282
+#define TK_GE 283
+#define TK_INDEX 284
+#define TK_SIZE 285
+#define TK_LETBANG 286
+#define TK_FETCHBANG 287
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 37 "src/parser.y"
+
+	StupidPtr<ast::Word>     word;
+	StupidPtr<ast::Var>      var;
+	StupidPtr<ast::Expr>     expr;
+	StupidPtr<ast::LeftExpr> lexpr;
+	StupidPtr<ast::Stmt>     stmt;
+	std::vector<unique_ptr<ast::Expr>>* exprs;
+
+#line 228 "build/parser.cpp"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_TK_AND2 = 3,                    /* TK_AND2  */
+  YYSYMBOL_TK_OR2 = 4,                     /* TK_OR2  */
+  YYSYMBOL_TK_RDT1 = 5,                    /* TK_RDT1  */
+  YYSYMBOL_TK_RDT2 = 6,                    /* TK_RDT2  */
+  YYSYMBOL_TK_RDFR = 7,                    /* TK_RDFR  */
+  YYSYMBOL_TK_WORD = 8,                    /* TK_WORD  */
+  YYSYMBOL_TK_VAR = 9,                     /* TK_VAR  */
+  YYSYMBOL_TK_IF = 10,                     /* TK_IF  */
+  YYSYMBOL_TK_ELSE = 11,                   /* TK_ELSE  */
+  YYSYMBOL_TK_WHILE = 12,                  /* TK_WHILE  */
+  YYSYMBOL_TK_BREAK = 13,                  /* TK_BREAK  */
+  YYSYMBOL_TK_RETURN = 14,                 /* TK_RETURN  */
+  YYSYMBOL_TK_LET = 15,                    /* TK_LET  */
+  YYSYMBOL_TK_FUN = 16,                    /* TK_FUN  */
+  YYSYMBOL_TK_WHEN = 17,                   /* TK_WHEN  */
+  YYSYMBOL_TK_FETCH = 18,                  /* TK_FETCH  */
+  YYSYMBOL_TK_YIELD = 19,                  /* TK_YIELD  */
+  YYSYMBOL_TK_DEFER = 20,                  /* TK_DEFER  */
+  YYSYMBOL_TK_FOR = 21,                    /* TK_FOR  */
+  YYSYMBOL_TK_ZIP = 22,                    /* TK_ZIP  */
+  YYSYMBOL_TK_CHDIR = 23,                  /* TK_CHDIR  */
+  YYSYMBOL_TK_ARROW = 24,                  /* TK_ARROW  */
+  YYSYMBOL_TK_EQ = 25,                     /* TK_EQ  */
+  YYSYMBOL_TK_NE = 26,                     /* TK_NE  */
+  YYSYMBOL_TK_LE = 27,                     /* TK_LE  */
+  YYSYMBOL_TK_GE = 28,                     /* TK_GE  */
+  YYSYMBOL_TK_INDEX = 29,                  /* TK_INDEX  */
+  YYSYMBOL_TK_SIZE = 30,                   /* TK_SIZE  */
+  YYSYMBOL_TK_LETBANG = 31,                /* TK_LETBANG  */
+  YYSYMBOL_TK_FETCHBANG = 32,              /* TK_FETCHBANG  */
+  YYSYMBOL_33_ = 33,                       /* ';'  */
+  YYSYMBOL_34_ = 34,                       /* '&'  */
+  YYSYMBOL_35_ = 35,                       /* '!'  */
+  YYSYMBOL_36_ = 36,                       /* '|'  */
+  YYSYMBOL_37_ = 37,                       /* '{'  */
+  YYSYMBOL_38_ = 38,                       /* '}'  */
+  YYSYMBOL_39_ = 39,                       /* '='  */
+  YYSYMBOL_40_ = 40,                       /* '('  */
+  YYSYMBOL_41_ = 41,                       /* ')'  */
+  YYSYMBOL_42_ = 42,                       /* '^'  */
+  YYSYMBOL_43_ = 43,                       /* '<'  */
+  YYSYMBOL_44_ = 44,                       /* '>'  */
+  YYSYMBOL_45_ = 45,                       /* '+'  */
+  YYSYMBOL_46_ = 46,                       /* '-'  */
+  YYSYMBOL_47_ = 47,                       /* '/'  */
+  YYSYMBOL_48_ = 48,                       /* '%'  */
+  YYSYMBOL_49_ = 49,                       /* '*'  */
+  YYSYMBOL_50_ = 50,                       /* '~'  */
+  YYSYMBOL_51_ = 51,                       /* ':'  */
+  YYSYMBOL_52_ = 52,                       /* '['  */
+  YYSYMBOL_53_ = 53,                       /* ']'  */
+  YYSYMBOL_YYACCEPT = 54,                  /* $accept  */
+  YYSYMBOL_top = 55,                       /* top  */
+  YYSYMBOL_stmt_seq = 56,                  /* stmt_seq  */
+  YYSYMBOL_stmt_empty = 57,                /* stmt_empty  */
+  YYSYMBOL_stmt_bg = 58,                   /* stmt_bg  */
+  YYSYMBOL_stmt_par = 59,                  /* stmt_par  */
+  YYSYMBOL_stmt_andor = 60,                /* stmt_andor  */
+  YYSYMBOL_stmt_not = 61,                  /* stmt_not  */
+  YYSYMBOL_stmt_redir = 62,                /* stmt_redir  */
+  YYSYMBOL_stmt_pipe = 63,                 /* stmt_pipe  */
+  YYSYMBOL_stmt_prim = 64,                 /* stmt_prim  */
+  YYSYMBOL_if_ = 65,                       /* if_  */
+  YYSYMBOL_else_ = 66,                     /* else_  */
+  YYSYMBOL_lexpr_prim = 67,                /* lexpr_prim  */
+  YYSYMBOL_lexpr_list = 68,                /* lexpr_list  */
+  YYSYMBOL_expr_list = 69,                 /* expr_list  */
+  YYSYMBOL_expr_pair = 70,                 /* expr_pair  */
+  YYSYMBOL_expr_concat = 71,               /* expr_concat  */
+  YYSYMBOL_expr_prim = 72,                 /* expr_prim  */
+  YYSYMBOL_arith_bool = 73,                /* arith_bool  */
+  YYSYMBOL_arith_add = 74,                 /* arith_add  */
+  YYSYMBOL_arith_div = 75,                 /* arith_div  */
+  YYSYMBOL_arith_mul = 76,                 /* arith_mul  */
+  YYSYMBOL_arith_pos = 77,                 /* arith_pos  */
+  YYSYMBOL_arith_pair = 78,                /* arith_pair  */
+  YYSYMBOL_arith_concat = 79,              /* arith_concat  */
+  YYSYMBOL_arith_prim = 80,                /* arith_prim  */
+  YYSYMBOL_symbols = 81                    /* symbols  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  82
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   408
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  54
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  28
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  100
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  183
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   287
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    35,     2,     2,     2,    48,    34,     2,
+      40,    41,    49,    45,     2,    46,     2,    47,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    51,    33,
+      43,    39,    44,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    52,     2,    53,    42,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    37,    36,    38,    50,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_uint8 yyrline[] =
+{
+       0,    66,    66,    70,    71,    74,    75,    78,    79,    82,
+      83,    87,    88,    89,    92,    93,    96,    97,    98,   101,
+     102,   103,   104,   107,   108,   109,   110,   111,   112,   113,
+     114,   115,   116,   117,   118,   119,   120,   121,   122,   123,
+     124,   127,   130,   131,   132,   135,   136,   139,   140,   141,
+     144,   145,   149,   150,   153,   154,   157,   158,   159,   162,
+     163,   164,   165,   166,   167,   170,   171,   172,   175,   176,
+     177,   180,   181,   184,   185,   186,   189,   190,   193,   194,
+     197,   198,   199,   200,   201,   202,   203,   204,   205,   208,
+     209,   210,   211,   212,   213,   214,   215,   216,   217,   218,
+     219
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "TK_AND2", "TK_OR2",
+  "TK_RDT1", "TK_RDT2", "TK_RDFR", "TK_WORD", "TK_VAR", "TK_IF", "TK_ELSE",
+  "TK_WHILE", "TK_BREAK", "TK_RETURN", "TK_LET", "TK_FUN", "TK_WHEN",
+  "TK_FETCH", "TK_YIELD", "TK_DEFER", "TK_FOR", "TK_ZIP", "TK_CHDIR",
+  "TK_ARROW", "TK_EQ", "TK_NE", "TK_LE", "TK_GE", "TK_INDEX", "TK_SIZE",
+  "TK_LETBANG", "TK_FETCHBANG", "';'", "'&'", "'!'", "'|'", "'{'", "'}'",
+  "'='", "'('", "')'", "'^'", "'<'", "'>'", "'+'", "'-'", "'/'", "'%'",
+  "'*'", "'~'", "':'", "'['", "']'", "$accept", "top", "stmt_seq",
+  "stmt_empty", "stmt_bg", "stmt_par", "stmt_andor", "stmt_not",
+  "stmt_redir", "stmt_pipe", "stmt_prim", "if_", "else_", "lexpr_prim",
+  "lexpr_list", "expr_list", "expr_pair", "expr_concat", "expr_prim",
+  "arith_bool", "arith_add", "arith_div", "arith_mul", "arith_pos",
+  "arith_pair", "arith_concat", "arith_prim", "symbols", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-130)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-54)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+     159,  -130,  -130,   204,   204,   307,   307,  -130,   307,  -130,
+     307,   307,  -130,  -130,   307,  -130,  -130,  -130,  -130,    97,
+    -130,   204,   249,   159,    16,  -130,  -130,  -130,  -130,  -130,
+    -130,  -130,  -130,  -130,   159,    28,  -130,    -1,  -130,     3,
+    -130,    70,  -130,    24,  -130,  -130,    29,   279,  -130,  -130,
+    -130,     2,    14,  -130,   279,  -130,     9,     4,   -21,  -130,
+    -130,  -130,    -6,   307,  -130,    16,   334,   334,    46,    85,
+      21,  -130,  -130,   331,  -130,     3,  -130,    39,  -130,    61,
+     350,    36,  -130,   159,   204,   204,   204,   307,   307,   249,
+     249,   249,   307,    48,   159,   159,  -130,    97,  -130,  -130,
+      87,  -130,    88,   204,   159,    65,    35,  -130,  -130,  -130,
+      97,    97,    97,    97,    97,    97,   334,  -130,  -130,  -130,
+      97,    97,    97,    97,  -130,    97,    97,  -130,  -130,  -130,
+    -130,  -130,    65,    65,  -130,   279,  -130,  -130,  -130,    84,
+      91,  -130,   362,   100,   159,   -11,   110,    85,    85,    90,
+      21,    21,  -130,  -130,    93,    93,    93,    93,    93,    93,
+    -130,   144,   144,  -130,   118,   307,   159,   144,  -130,    17,
+    -130,  -130,   143,  -130,  -130,   119,  -130,   159,  -130,   144,
+     120,  -130,  -130
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       5,    80,    82,    53,    53,    53,    53,    49,     0,    49,
+      53,    53,    49,    51,    53,    97,    98,    99,   100,     0,
+      83,    53,    53,     5,     0,    94,    95,    89,    90,    92,
+      93,    91,    81,    96,     5,     0,     2,     4,     6,     8,
+      10,    13,    15,    18,    22,    23,     0,    53,    55,    57,
+      56,     0,     0,    28,    53,    29,     0,    45,    49,    32,
+      33,    35,     0,    34,    36,     0,     0,     0,     0,    67,
+      70,    72,    75,    77,    79,     7,    14,     0,    86,     0,
+       0,     0,     1,     5,    53,    53,    53,     0,     0,     0,
+       0,     0,     0,    40,     5,     5,    52,     0,    48,    47,
+       0,    38,     0,    53,     5,    50,     0,    73,    74,    84,
+       0,     0,     0,     0,     0,     0,     0,    76,    39,    58,
+       0,     0,     0,     0,    87,     0,     0,    88,     3,     9,
+      11,    12,    16,    17,    19,    53,    20,    21,    54,     0,
+       0,    30,    31,     0,     5,     0,     0,    65,    66,     0,
+      68,    69,    71,    78,    59,    60,    61,    62,    63,    64,
+      40,    44,    44,    49,     0,    53,     5,    44,    85,     0,
+      41,    24,    46,    37,    26,     0,    25,     5,    43,    44,
+       0,    27,    42
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -130,  -130,   -16,  -130,  -130,   138,    31,  -130,   140,  -130,
+      55,    -4,  -129,    11,     0,  -130,     5,    -5,    72,    79,
+     -22,   -17,    40,    75,   -26,  -130,    -2,  -130
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
+{
+       0,    35,    36,    37,    38,    39,    40,    41,    42,    43,
+      44,    45,   170,    56,    57,    63,    46,    47,    48,    79,
+      68,    69,    70,    71,    72,    73,    49,    50
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      54,    54,    80,    58,   103,    54,    54,    77,   165,    54,
+      53,    55,    98,    99,   101,    60,    61,    74,    81,    64,
+      59,    92,    74,    62,     1,     2,   166,     3,    82,    87,
+      88,   104,    83,   171,    51,    52,    90,    84,   176,    94,
+     107,   108,    54,   106,   100,    19,    20,   117,    97,    54,
+     181,    95,    93,    91,   177,   -52,    65,    78,   105,    96,
+      89,    66,    67,    74,    74,    74,    32,   128,    34,   102,
+     115,    74,   -52,    85,    86,   142,   124,   118,   139,   140,
+     110,   111,   132,   133,   135,   135,   135,   109,   146,   127,
+     149,   110,   111,   147,   148,    74,   143,   112,   154,   155,
+     156,   157,   119,   158,   159,     1,     2,    92,    74,    74,
+      74,    74,    74,    74,   153,   129,   130,   131,    74,    74,
+      74,    74,   161,    74,    74,   144,    19,    20,   164,   162,
+      54,   168,   113,   114,   145,   110,   111,    65,   110,   111,
+     160,   163,    66,    67,   134,   136,   137,    32,   167,    34,
+     175,    98,    99,   150,   151,   169,   173,   179,   182,    75,
+      54,   180,    76,   172,   138,   178,   -53,     1,     2,     3,
+     174,     4,     5,     6,     7,     8,   141,     9,    10,    11,
+      12,    13,    14,   -53,    15,    16,    17,    18,    19,    20,
+     152,     0,     0,    21,    22,     0,    23,     0,     0,    24,
+       0,     0,    25,    26,    27,    28,    29,    30,    31,    32,
+      33,    34,     1,     2,     3,     0,     4,     5,     6,     7,
+       8,     0,     9,    10,    11,    12,    13,    14,     0,    15,
+      16,    17,    18,    19,    20,     0,     0,     0,     0,    22,
+       0,    23,     0,     0,    24,     0,     0,    25,    26,    27,
+      28,    29,    30,    31,    32,    33,    34,     1,     2,     3,
+       0,     4,     5,     6,     7,     8,     0,     9,    10,    11,
+      12,    13,    14,     0,    15,    16,    17,    18,    19,    20,
+       0,     0,     0,     0,     0,     0,    23,     1,     2,    24,
+       0,     0,    25,    26,    27,    28,    29,    30,    31,    32,
+      33,    34,     0,     0,    15,    16,    17,    18,    19,    20,
+       0,     0,     0,     0,     0,     1,     2,     0,     0,    24,
+       0,    92,    25,    26,    27,    28,    29,    30,    31,    32,
+      33,    34,    15,    16,    17,    18,    19,    20,     0,     1,
+       2,     0,     1,     2,     0,     0,     0,    24,     0,     0,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      19,    20,     0,    19,    20,     0,     0,     0,     0,     0,
+       0,    65,     0,   116,    65,   120,   121,   122,   123,     0,
+       0,    32,     0,    34,    32,     0,    34,   120,   121,   122,
+     123,   124,     0,   125,   126,   110,   111,     0,     0,     0,
+       0,     0,     0,     0,     0,   125,   126,   110,   111
+};
+
+static const yytype_int16 yycheck[] =
+{
+       5,     6,    24,     8,    10,    10,    11,    23,    19,    14,
+       5,     6,     8,     9,    35,    10,    11,    19,    34,    14,
+       9,    42,    24,    12,     8,     9,    37,    10,     0,     5,
+       6,    37,    33,   162,     3,     4,     7,    34,   167,    37,
+      66,    67,    47,    65,    40,    29,    30,    73,    39,    54,
+     179,    37,    47,    24,    37,     7,    40,    41,    63,    54,
+      36,    45,    46,    65,    66,    67,    50,    83,    52,    58,
+      49,    73,    24,     3,     4,    97,    41,    38,    94,    95,
+      45,    46,    87,    88,    89,    90,    91,    41,   104,    53,
+     112,    45,    46,   110,   111,    97,     9,    51,   120,   121,
+     122,   123,    41,   125,   126,     8,     9,    42,   110,   111,
+     112,   113,   114,   115,   116,    84,    85,    86,   120,   121,
+     122,   123,    38,   125,   126,    37,    29,    30,   144,    38,
+     135,    41,    47,    48,   103,    45,    46,    40,    45,    46,
+     135,    41,    45,    46,    89,    90,    91,    50,    38,    52,
+     166,     8,     9,   113,   114,    11,    38,    38,    38,    21,
+     165,   177,    22,   163,    92,   169,     7,     8,     9,    10,
+     165,    12,    13,    14,    15,    16,    97,    18,    19,    20,
+      21,    22,    23,    24,    25,    26,    27,    28,    29,    30,
+     115,    -1,    -1,    34,    35,    -1,    37,    -1,    -1,    40,
+      -1,    -1,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    52,     8,     9,    10,    -1,    12,    13,    14,    15,
+      16,    -1,    18,    19,    20,    21,    22,    23,    -1,    25,
+      26,    27,    28,    29,    30,    -1,    -1,    -1,    -1,    35,
+      -1,    37,    -1,    -1,    40,    -1,    -1,    43,    44,    45,
+      46,    47,    48,    49,    50,    51,    52,     8,     9,    10,
+      -1,    12,    13,    14,    15,    16,    -1,    18,    19,    20,
+      21,    22,    23,    -1,    25,    26,    27,    28,    29,    30,
+      -1,    -1,    -1,    -1,    -1,    -1,    37,     8,     9,    40,
+      -1,    -1,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    52,    -1,    -1,    25,    26,    27,    28,    29,    30,
+      -1,    -1,    -1,    -1,    -1,     8,     9,    -1,    -1,    40,
+      -1,    42,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    52,    25,    26,    27,    28,    29,    30,    -1,     8,
+       9,    -1,     8,     9,    -1,    -1,    -1,    40,    -1,    -1,
+      43,    44,    45,    46,    47,    48,    49,    50,    51,    52,
+      29,    30,    -1,    29,    30,    -1,    -1,    -1,    -1,    -1,
+      -1,    40,    -1,    42,    40,    25,    26,    27,    28,    -1,
+      -1,    50,    -1,    52,    50,    -1,    52,    25,    26,    27,
+      28,    41,    -1,    43,    44,    45,    46,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    43,    44,    45,    46
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,     8,     9,    10,    12,    13,    14,    15,    16,    18,
+      19,    20,    21,    22,    23,    25,    26,    27,    28,    29,
+      30,    34,    35,    37,    40,    43,    44,    45,    46,    47,
+      48,    49,    50,    51,    52,    55,    56,    57,    58,    59,
+      60,    61,    62,    63,    64,    65,    70,    71,    72,    80,
+      81,    60,    60,    70,    71,    70,    67,    68,    71,    67,
+      70,    70,    67,    69,    70,    40,    45,    46,    74,    75,
+      76,    77,    78,    79,    80,    59,    62,    56,    41,    73,
+      74,    56,     0,    33,    34,     3,     4,     5,     6,    36,
+       7,    24,    42,    70,    37,    37,    70,    39,     8,     9,
+      40,    35,    67,    10,    37,    71,    74,    78,    78,    41,
+      45,    46,    51,    47,    48,    49,    42,    78,    38,    41,
+      25,    26,    27,    28,    41,    43,    44,    53,    56,    60,
+      60,    60,    71,    71,    64,    71,    64,    64,    72,    56,
+      56,    73,    74,     9,    37,    60,    56,    75,    75,    74,
+      76,    76,    77,    80,    74,    74,    74,    74,    74,    74,
+      70,    38,    38,    41,    56,    19,    37,    38,    41,    11,
+      66,    66,    68,    38,    70,    56,    66,    37,    65,    38,
+      56,    66,    38
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    54,    55,    56,    56,    57,    57,    58,    58,    59,
+      59,    60,    60,    60,    61,    61,    62,    62,    62,    63,
+      63,    63,    63,    64,    64,    64,    64,    64,    64,    64,
+      64,    64,    64,    64,    64,    64,    64,    64,    64,    64,
+      64,    65,    66,    66,    66,    67,    67,    68,    68,    68,
+      69,    69,    70,    70,    71,    71,    72,    72,    72,    73,
+      73,    73,    73,    73,    73,    74,    74,    74,    75,    75,
+      75,    76,    76,    77,    77,    77,    78,    78,    79,    79,
+      80,    80,    80,    80,    80,    80,    80,    80,    80,    81,
+      81,    81,    81,    81,    81,    81,    81,    81,    81,    81,
+      81
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     3,     1,     0,     1,     2,     1,     3,
+       1,     3,     3,     1,     2,     1,     3,     3,     1,     3,
+       3,     3,     1,     1,     6,     6,     6,     8,     2,     2,
+       4,     4,     2,     2,     2,     2,     2,     6,     3,     3,
+       2,     6,     4,     2,     0,     1,     5,     2,     2,     0,
+       2,     0,     2,     0,     3,     1,     1,     1,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     1,     3,     3,
+       1,     3,     1,     2,     2,     1,     2,     1,     3,     1,
+       1,     1,     1,     1,     3,     5,     2,     3,     3,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* top: stmt_seq  */
+#line 66 "src/parser.y"
+                                                                { ::_parserResult = (yyvsp[0].stmt); }
+#line 1456 "build/parser.cpp"
+    break;
+
+  case 3: /* stmt_seq: stmt_empty ';' stmt_seq  */
+#line 70 "src/parser.y"
+                                                { (yyval.stmt) = new Sequence( (yyvsp[-2].stmt), (yyvsp[0].stmt) ); }
+#line 1462 "build/parser.cpp"
+    break;
+
+  case 5: /* stmt_empty: %empty  */
+#line 74 "src/parser.y"
+                                                                        { (yyval.stmt) = new None( 0 ); }
+#line 1468 "build/parser.cpp"
+    break;
+
+  case 7: /* stmt_bg: '&' stmt_par  */
+#line 78 "src/parser.y"
+                                                        { (yyval.stmt) = new Bg( (yyvsp[0].stmt) ); }
+#line 1474 "build/parser.cpp"
+    break;
+
+  case 9: /* stmt_par: stmt_par '&' stmt_andor  */
+#line 82 "src/parser.y"
+                                                { (yyval.stmt) = new Parallel( (yyvsp[-2].stmt), (yyvsp[0].stmt) ); }
+#line 1480 "build/parser.cpp"
+    break;
+
+  case 11: /* stmt_andor: stmt_not TK_AND2 stmt_andor  */
+#line 87 "src/parser.y"
+                                        { (yyval.stmt) = new If( (yyvsp[-2].stmt), (yyvsp[0].stmt), make_unique<None>( 1 ) ); }
+#line 1486 "build/parser.cpp"
+    break;
+
+  case 12: /* stmt_andor: stmt_not TK_OR2 stmt_andor  */
+#line 88 "src/parser.y"
+                                        { (yyval.stmt) = new If( (yyvsp[-2].stmt), make_unique<None>( 0 ), (yyvsp[0].stmt) ); }
+#line 1492 "build/parser.cpp"
+    break;
+
+  case 14: /* stmt_not: '!' stmt_redir  */
+#line 92 "src/parser.y"
+                                                        { (yyval.stmt) = new If( (yyvsp[0].stmt), make_unique<None>( 1 ), make_unique<None>( 0 ) ); }
+#line 1498 "build/parser.cpp"
+    break;
+
+  case 16: /* stmt_redir: stmt_pipe TK_RDT1 expr_concat  */
+#line 96 "src/parser.y"
+                                        { (yyval.stmt) = new RedirTo( (yyvsp[-2].stmt), (yyvsp[0].expr) ); }
+#line 1504 "build/parser.cpp"
+    break;
+
+  case 17: /* stmt_redir: stmt_pipe TK_RDT2 expr_concat  */
+#line 97 "src/parser.y"
+                                        { (yyval.stmt) = new RedirTo( (yyvsp[-2].stmt), (yyvsp[0].expr) ); }
+#line 1510 "build/parser.cpp"
+    break;
+
+  case 19: /* stmt_pipe: stmt_pipe '|' stmt_prim  */
+#line 101 "src/parser.y"
+                                                { (yyval.stmt) = new Pipe( (yyvsp[-2].stmt), (yyvsp[0].stmt) ); }
+#line 1516 "build/parser.cpp"
+    break;
+
+  case 20: /* stmt_pipe: expr_pair TK_RDFR stmt_prim  */
+#line 102 "src/parser.y"
+                                        { (yyval.stmt) = new RedirFr( (yyvsp[0].stmt), (yyvsp[-2].expr) ); }
+#line 1522 "build/parser.cpp"
+    break;
+
+  case 21: /* stmt_pipe: expr_pair TK_ARROW stmt_prim  */
+#line 103 "src/parser.y"
+                                        { (yyval.stmt) = new Pipe( make_unique<Yield>( (yyvsp[-2].expr) ), (yyvsp[0].stmt) ); }
+#line 1528 "build/parser.cpp"
+    break;
+
+  case 24: /* stmt_prim: TK_WHILE stmt_andor '{' stmt_seq '}' else_  */
+#line 108 "src/parser.y"
+                                                                { (yyval.stmt) = new While( (yyvsp[-4].stmt), (yyvsp[-2].stmt), (yyvsp[0].stmt) ); }
+#line 1534 "build/parser.cpp"
+    break;
+
+  case 25: /* stmt_prim: TK_FOR lexpr_prim '{' stmt_seq '}' else_  */
+#line 109 "src/parser.y"
+                                                                        { (yyval.stmt) = nullptr; }
+#line 1540 "build/parser.cpp"
+    break;
+
+  case 26: /* stmt_prim: TK_FOR lexpr_prim TK_IF stmt_andor TK_YIELD expr_pair  */
+#line 110 "src/parser.y"
+                                                                { (yyval.stmt) = nullptr; }
+#line 1546 "build/parser.cpp"
+    break;
+
+  case 27: /* stmt_prim: TK_FOR lexpr_prim TK_IF stmt_andor '{' stmt_seq '}' else_  */
+#line 111 "src/parser.y"
+                                                                    { (yyval.stmt) = nullptr; }
+#line 1552 "build/parser.cpp"
+    break;
+
+  case 28: /* stmt_prim: TK_BREAK expr_pair  */
+#line 112 "src/parser.y"
+                                                                                        { (yyval.stmt) = new Break( (yyvsp[0].expr) ); }
+#line 1558 "build/parser.cpp"
+    break;
+
+  case 29: /* stmt_prim: TK_RETURN expr_pair  */
+#line 113 "src/parser.y"
+                                                                                        { (yyval.stmt) = new Return( (yyvsp[0].expr) ); }
+#line 1564 "build/parser.cpp"
+    break;
+
+  case 30: /* stmt_prim: TK_LET lexpr_prim '=' arith_bool  */
+#line 114 "src/parser.y"
+                                                                                { (yyval.stmt) = new Let( (yyvsp[-2].lexpr), (yyvsp[0].expr) ); }
+#line 1570 "build/parser.cpp"
+    break;
+
+  case 31: /* stmt_prim: TK_LET lexpr_prim '=' arith_add  */
+#line 115 "src/parser.y"
+                                                                                { (yyval.stmt) = new Let( (yyvsp[-2].lexpr), (yyvsp[0].expr) ); }
+#line 1576 "build/parser.cpp"
+    break;
+
+  case 32: /* stmt_prim: TK_FETCH lexpr_prim  */
+#line 116 "src/parser.y"
+                                                                                        { (yyval.stmt) = new Fetch( (yyvsp[0].lexpr) ); }
+#line 1582 "build/parser.cpp"
+    break;
+
+  case 33: /* stmt_prim: TK_YIELD expr_pair  */
+#line 117 "src/parser.y"
+                                                                                        { (yyval.stmt) = new Yield( (yyvsp[0].expr) ); }
+#line 1588 "build/parser.cpp"
+    break;
+
+  case 34: /* stmt_prim: TK_ZIP expr_list  */
+#line 118 "src/parser.y"
+                                                                                                { (yyval.stmt) = new Zip( move( *(yyvsp[0].exprs) ) ); delete (yyvsp[0].exprs); }
+#line 1594 "build/parser.cpp"
+    break;
+
+  case 35: /* stmt_prim: TK_DEFER expr_pair  */
+#line 119 "src/parser.y"
+                                                                                        { (yyval.stmt) = new Defer( (yyvsp[0].expr) ); }
+#line 1600 "build/parser.cpp"
+    break;
+
+  case 36: /* stmt_prim: TK_CHDIR expr_pair  */
+#line 120 "src/parser.y"
+                                                                                        { (yyval.stmt) = new ChDir( (yyvsp[0].expr) ); }
+#line 1606 "build/parser.cpp"
+    break;
+
+  case 37: /* stmt_prim: TK_FUN expr_concat lexpr_prim '{' stmt_seq '}'  */
+#line 121 "src/parser.y"
+                                                                { (yyval.stmt) = new Fun( (yyvsp[-4].expr), (yyvsp[-3].lexpr), (yyvsp[-1].stmt) ); }
+#line 1612 "build/parser.cpp"
+    break;
+
+  case 38: /* stmt_prim: TK_FUN expr_concat '!'  */
+#line 122 "src/parser.y"
+                                                                                        { (yyval.stmt) = new FunDel( (yyvsp[-1].expr) ); }
+#line 1618 "build/parser.cpp"
+    break;
+
+  case 39: /* stmt_prim: '{' stmt_seq '}'  */
+#line 123 "src/parser.y"
+                                                                                                { (yyval.stmt) = (yyvsp[-1].stmt); }
+#line 1624 "build/parser.cpp"
+    break;
+
+  case 40: /* stmt_prim: expr_concat expr_pair  */
+#line 124 "src/parser.y"
+                                                                                        { (yyval.stmt) = new Command( make_unique<Pair>( (yyvsp[-1].expr), (yyvsp[0].expr) ) ); }
+#line 1630 "build/parser.cpp"
+    break;
+
+  case 41: /* if_: TK_IF stmt_andor '{' stmt_seq '}' else_  */
+#line 127 "src/parser.y"
+                                                                        { (yyval.stmt) = new If( (yyvsp[-4].stmt), (yyvsp[-2].stmt), (yyvsp[0].stmt) ); }
+#line 1636 "build/parser.cpp"
+    break;
+
+  case 42: /* else_: TK_ELSE '{' stmt_seq '}'  */
+#line 130 "src/parser.y"
+                                                        { (yyval.stmt) = (yyvsp[-1].stmt); }
+#line 1642 "build/parser.cpp"
+    break;
+
+  case 43: /* else_: TK_ELSE if_  */
+#line 131 "src/parser.y"
+                                                                { (yyval.stmt) = (yyvsp[0].stmt); }
+#line 1648 "build/parser.cpp"
+    break;
+
+  case 44: /* else_: %empty  */
+#line 132 "src/parser.y"
+                                                                                { (yyval.stmt) = new None( 0 ); }
+#line 1654 "build/parser.cpp"
+    break;
+
+  case 45: /* lexpr_prim: lexpr_list  */
+#line 135 "src/parser.y"
+                                                                { (yyval.lexpr) = new LeftFix( move( *(yyvsp[0].exprs) ) ); delete (yyvsp[0].exprs); }
+#line 1660 "build/parser.cpp"
+    break;
+
+  case 46: /* lexpr_prim: lexpr_list '(' TK_VAR ')' lexpr_list  */
+#line 136 "src/parser.y"
+                                                { (yyval.lexpr) = new LeftVar( move( *(yyvsp[-4].exprs) ), (yyvsp[-2].var), move( *(yyvsp[0].exprs) ) ); delete (yyvsp[-4].exprs); delete (yyvsp[0].exprs); }
+#line 1666 "build/parser.cpp"
+    break;
+
+  case 47: /* lexpr_list: lexpr_list TK_VAR  */
+#line 139 "src/parser.y"
+                                                                { (yyvsp[-1].exprs)->push_back( (yyvsp[0].var) ); (yyval.exprs) = (yyvsp[-1].exprs); }
+#line 1672 "build/parser.cpp"
+    break;
+
+  case 48: /* lexpr_list: lexpr_list TK_WORD  */
+#line 140 "src/parser.y"
+                                                        { (yyvsp[-1].exprs)->push_back( (yyvsp[0].word) ); (yyval.exprs) = (yyvsp[-1].exprs); }
+#line 1678 "build/parser.cpp"
+    break;
+
+  case 49: /* lexpr_list: %empty  */
+#line 141 "src/parser.y"
+                                                                                { (yyval.exprs) = new vector<unique_ptr<Expr>>(); }
+#line 1684 "build/parser.cpp"
+    break;
+
+  case 50: /* expr_list: expr_list expr_concat  */
+#line 144 "src/parser.y"
+                                                        { (yyvsp[-1].exprs)->push_back( (yyvsp[0].expr) ); (yyval.exprs) = (yyvsp[-1].exprs); }
+#line 1690 "build/parser.cpp"
+    break;
+
+  case 51: /* expr_list: %empty  */
+#line 145 "src/parser.y"
+                                                                                { (yyval.exprs) = new vector<unique_ptr<Expr>>(); }
+#line 1696 "build/parser.cpp"
+    break;
+
+  case 52: /* expr_pair: expr_concat expr_pair  */
+#line 149 "src/parser.y"
+                                                        { (yyval.expr) = new Pair( (yyvsp[-1].expr), (yyvsp[0].expr) ); }
+#line 1702 "build/parser.cpp"
+    break;
+
+  case 53: /* expr_pair: %empty  */
+#line 150 "src/parser.y"
+                                                                                { (yyval.expr) = new Null(); }
+#line 1708 "build/parser.cpp"
+    break;
+
+  case 54: /* expr_concat: expr_concat '^' expr_prim  */
+#line 153 "src/parser.y"
+                                                        { (yyval.expr) = new Concat( (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1714 "build/parser.cpp"
+    break;
+
+  case 56: /* expr_prim: symbols  */
+#line 157 "src/parser.y"
+                                                                        { (yyval.expr) = (yyvsp[0].word); }
+#line 1720 "build/parser.cpp"
+    break;
+
+  case 58: /* expr_prim: '(' arith_bool ')'  */
+#line 159 "src/parser.y"
+                                                        { (yyval.expr) = (yyvsp[-1].expr); }
+#line 1726 "build/parser.cpp"
+    break;
+
+  case 59: /* arith_bool: arith_add TK_EQ arith_add  */
+#line 162 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::eq, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1732 "build/parser.cpp"
+    break;
+
+  case 60: /* arith_bool: arith_add TK_NE arith_add  */
+#line 163 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::ne, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1738 "build/parser.cpp"
+    break;
+
+  case 61: /* arith_bool: arith_add TK_LE arith_add  */
+#line 164 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::le, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1744 "build/parser.cpp"
+    break;
+
+  case 62: /* arith_bool: arith_add TK_GE arith_add  */
+#line 165 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::ge, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1750 "build/parser.cpp"
+    break;
+
+  case 63: /* arith_bool: arith_add '<' arith_add  */
+#line 166 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::lt, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1756 "build/parser.cpp"
+    break;
+
+  case 64: /* arith_bool: arith_add '>' arith_add  */
+#line 167 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::gt, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1762 "build/parser.cpp"
+    break;
+
+  case 65: /* arith_add: arith_add '+' arith_div  */
+#line 170 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::add, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1768 "build/parser.cpp"
+    break;
+
+  case 66: /* arith_add: arith_add '-' arith_div  */
+#line 171 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::sub, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1774 "build/parser.cpp"
+    break;
+
+  case 68: /* arith_div: arith_div '/' arith_mul  */
+#line 175 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::div, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1780 "build/parser.cpp"
+    break;
+
+  case 69: /* arith_div: arith_div '%' arith_mul  */
+#line 176 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::mod, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1786 "build/parser.cpp"
+    break;
+
+  case 71: /* arith_mul: arith_mul '*' arith_pos  */
+#line 180 "src/parser.y"
+                                                        { (yyval.expr) = new BinOp( BinOp::mul, (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1792 "build/parser.cpp"
+    break;
+
+  case 73: /* arith_pos: '+' arith_pair  */
+#line 184 "src/parser.y"
+                                                                { (yyval.expr) = new UniOp( UniOp::pos, (yyvsp[0].expr) ); }
+#line 1798 "build/parser.cpp"
+    break;
+
+  case 74: /* arith_pos: '-' arith_pair  */
+#line 185 "src/parser.y"
+                                                                { (yyval.expr) = new UniOp( UniOp::neg, (yyvsp[0].expr) ); }
+#line 1804 "build/parser.cpp"
+    break;
+
+  case 76: /* arith_pair: arith_concat arith_pair  */
+#line 189 "src/parser.y"
+                                                        { (yyval.expr) = new Pair( (yyvsp[-1].expr), (yyvsp[0].expr) ); }
+#line 1810 "build/parser.cpp"
+    break;
+
+  case 78: /* arith_concat: arith_concat '^' arith_prim  */
+#line 193 "src/parser.y"
+                                                { (yyval.expr) = new Concat( (yyvsp[-2].expr), (yyvsp[0].expr) ); }
+#line 1816 "build/parser.cpp"
+    break;
+
+  case 80: /* arith_prim: TK_WORD  */
+#line 197 "src/parser.y"
+                                                                        { (yyval.expr) = (yyvsp[0].word); }
+#line 1822 "build/parser.cpp"
+    break;
+
+  case 81: /* arith_prim: '~'  */
+#line 198 "src/parser.y"
+                                                                        { (yyval.expr) = new Home(); }
+#line 1828 "build/parser.cpp"
+    break;
+
+  case 82: /* arith_prim: TK_VAR  */
+#line 199 "src/parser.y"
+                                                                        { (yyval.expr) = (yyvsp[0].var); }
+#line 1834 "build/parser.cpp"
+    break;
+
+  case 83: /* arith_prim: TK_SIZE  */
+#line 200 "src/parser.y"
+                                                                        { (yyval.expr) = new Size( (yyvsp[0].var) ); }
+#line 1840 "build/parser.cpp"
+    break;
+
+  case 84: /* arith_prim: TK_INDEX arith_add ')'  */
+#line 201 "src/parser.y"
+                                                        { (yyval.expr) = new Index( (yyvsp[-2].var), (yyvsp[-1].expr) ); }
+#line 1846 "build/parser.cpp"
+    break;
+
+  case 85: /* arith_prim: TK_INDEX arith_add ':' arith_add ')'  */
+#line 202 "src/parser.y"
+                                                { (yyval.expr) = new Slice( (yyvsp[-4].var), (yyvsp[-3].expr), (yyvsp[-1].expr) ); }
+#line 1852 "build/parser.cpp"
+    break;
+
+  case 86: /* arith_prim: '(' ')'  */
+#line 203 "src/parser.y"
+                                                                        { (yyval.expr) = new Null(); }
+#line 1858 "build/parser.cpp"
+    break;
+
+  case 87: /* arith_prim: '(' arith_add ')'  */
+#line 204 "src/parser.y"
+                                                                { (yyval.expr) = (yyvsp[-1].expr); }
+#line 1864 "build/parser.cpp"
+    break;
+
+  case 88: /* arith_prim: '[' stmt_seq ']'  */
+#line 205 "src/parser.y"
+                                                                { (yyval.expr) = new Subst( (yyvsp[-1].stmt) ); }
+#line 1870 "build/parser.cpp"
+    break;
+
+  case 89: /* symbols: '+'  */
+#line 208 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '+' ) ); }
+#line 1876 "build/parser.cpp"
+    break;
+
+  case 90: /* symbols: '-'  */
+#line 209 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '-' ) ); }
+#line 1882 "build/parser.cpp"
+    break;
+
+  case 91: /* symbols: '*'  */
+#line 210 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '*', true ) ); }
+#line 1888 "build/parser.cpp"
+    break;
+
+  case 92: /* symbols: '/'  */
+#line 211 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '/' ) ); }
+#line 1894 "build/parser.cpp"
+    break;
+
+  case 93: /* symbols: '%'  */
+#line 212 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '%' ) ); }
+#line 1900 "build/parser.cpp"
+    break;
+
+  case 94: /* symbols: '<'  */
+#line 213 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '<' ) ); }
+#line 1906 "build/parser.cpp"
+    break;
+
+  case 95: /* symbols: '>'  */
+#line 214 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( '>' ) ); }
+#line 1912 "build/parser.cpp"
+    break;
+
+  case 96: /* symbols: ':'  */
+#line 215 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( ':' ) ); }
+#line 1918 "build/parser.cpp"
+    break;
+
+  case 97: /* symbols: TK_EQ  */
+#line 216 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( string( "==" ) ) ); }
+#line 1924 "build/parser.cpp"
+    break;
+
+  case 98: /* symbols: TK_NE  */
+#line 217 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( string( "!=" ) ) ); }
+#line 1930 "build/parser.cpp"
+    break;
+
+  case 99: /* symbols: TK_LE  */
+#line 218 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( string( "<=" ) ) ); }
+#line 1936 "build/parser.cpp"
+    break;
+
+  case 100: /* symbols: TK_GE  */
+#line 219 "src/parser.y"
+                                                                        { (yyval.word) = new Word( MetaString( string( ">=" ) ) ); }
+#line 1942 "build/parser.cpp"
+    break;
+
+
+#line 1946 "build/parser.cpp"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 221 "src/parser.y"
+
+
+unique_ptr<ast::Stmt> parse( istream& istr ) {
+	assert( !_parserResult );
+	lexerInit( &istr );
+	yyparse();
+	lexerInit( nullptr );
+	assert( _parserResult );
+
+	return std::move( _parserResult );
+}
+
+[[noreturn]] int yyerror( char const* ) {
+	// XXX: memory leak
+	throw SyntaxError( lexerLineNo() );
+}
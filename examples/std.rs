@@ -1,11 +1,3 @@
-fun size {
-	let $n = 0
-	while fetch $e {
-		let $n = $n + 1
-	}
-	yield $n
-}
-
 fun index $n {
 	enumerate | while fetch $i $e {
 		if ($i == $n) {
@@ -47,52 +39,6 @@ fun select ($cs) {
 	}
 }
 
-fun all {
-	while fetch $e {
-		if ! $e {
-			return -1
-		}
-	}
-	return 0
-}
-
-fun any {
-	while fetch $e {
-		if $e {
-			return 0
-		}
-	}
-	return -1
-}
-
-fun min {
-	fetch $r || return -1
-	while fetch $x {
-		if ($x < $r) {
-			let $r = $x
-		}
-	}
-	yield $r
-}
-
-fun max {
-	fetch $r || return -1
-	while fetch $x {
-		if ($x > $r) {
-			let $r = $x
-		}
-	}
-	yield $r
-}
-
-fun sum {
-	let $s = 0
-	while fetch $x {
-		let $s = $s + $x
-	}
-	yield $s
-}
-
 fun abs $x {
 	if ($x < 0) {
 		yield (- $x)
@@ -179,17 +125,6 @@ fun msort {
 	}
 }
 
-fun uniq {
-	fetch $x0 || return
-	yield $x0
-	while fetch $x1 {
-		if ($x0 != $x1) {
-			yield $x1
-			let $x0 = $x1
-		}
-	}
-}
-
 fun diff ($ys) {
 	while fetch $x {
 		if ($x != $ys) -> all {
@@ -1,5 +1,24 @@
 import std.rs
 
+// the number of the failed expectations, which fails the whole run.
+let $failures = 0
+
+fun equal ($xs) {
+	fetch ($ys)
+	(#xs == #ys) || return 1
+	zip ($xs) ($ys) | while fetch $x $y {
+		test $x "=" $y || return 1
+	}
+}
+
+// compares the values from stdin with the expected ones as strings.
+fun expect ($ys) {
+	fetch ($xs)
+	if ! $xs -> equal $ys {
+		echo "NG:" $xs "|" $ys
+		let $failures = $failures + 1
+	}
+}
 
 fun testLet {
 	yield "test let"
@@ -218,6 +237,151 @@ fun testDivMod {
 	echo (2 * 3 / 3 * 2 == 1)
 }
 
+fun testRecords {
+	fun multiLine {
+		yield "a\nb" "c\n"
+	}
+	let ($xs) = [multiLine]
+	$xs -> expect a b c ""
+	multiLine | expect a b c ""
+	multiLine | cat | expect a b c ""
+	{ printf a ; printf "b\n" ; printf c } | expect ab c
+	{ printf a ; printf "b\n" ; printf c } | cat | expect ab c
+}
+
+fun testStr {
+	yield ab cd | str chars | expect a b "" "" c d "" ""
+	yield abc de | str len | expect 3 2
+	yield abc de | str join | expect abcde
+	yield abc | str index 0 -1 | expect a c
+	yield abcd | str slice 1 3 | expect bc
+	yield a b c | str cmp b | expect -1 0 1
+	yield foo bar baz | str match "ba." | expect bar baz
+	yield foo bar | str subst "o" 0 | expect f00 bar
+	{ ! yield "" | str index 0 && yield OK } | expect OK
+}
+
+fun testBuiltins {
+	{ echo -n a b ; echo c } | expect "a bc"
+	echo -n | expect
+	printf "%s-%d|%5s|%-3s|%x\n" x 42 ab c 255 | expect "x-42|   ab|c  |ff"
+	printf "%s\n" a b c | expect a b c
+	printf "100%%\n" | expect "100%"
+	{ test 1 -lt 2 && test abc "=" abc && test -n abc && ! test -z abc && yield OK } | expect OK
+	{ "[" -d / "]" && ! "[" -f / "]" && "[" 3 -ge 3 "]" && yield OK } | expect OK
+	{ ! test 1 -gt 2 -a 2 -gt 1 && test 1 -gt 2 -o 2 -gt 1 && yield OK } | expect OK
+	yield [yield a b | cat] [yield c d | cat -] | expect a b c d
+}
+
+fun testCharClass {
+	fun names {
+		sort | str subst "^.*/" ""
+	}
+	let $dir = [mktemp -d]
+	chdir $dir
+	touch a1 a2 b1 b2 c.txt xd
+	yield ?[1-2] | names | expect a1 a2 b1 b2
+	yield *[a-c].txt | names | expect c.txt
+	yield ?[!1] | names | expect a2 b2 xd
+	yield ?[^2c] | names | expect a1 b1 xd
+	// a class only in a word with other wildcards.
+	yield *[pwd] | names | expect xd
+	yield [yield a]* | names | expect a1 a2
+	let $s = 1
+	yield *$s | names | expect a1 b1
+	yield a[echo 1] | expect a1
+	rm -r $dir
+}
+
+fun testTreeGlob {
+	let $dir = [mktemp -d]
+	fun names {
+		sort | str subst "^"^$dir/ ""
+	}
+	chdir $dir
+	mkdir -p a/b/c
+	touch x.c a/y.c a/b/z.c a/b/c/w.h
+	ln -s .. a/b/up
+	yield **/*.c | names | expect a/b/z.c a/y.c x.c
+	yield a/**/*.h | names | expect a/b/c/w.h
+	yield **/ | names | expect a/ a/b/ a/b/c/
+	rm -r $dir
+}
+
+fun testRegex {
+	let ($xs) = abc abd xbc a1c "a c" aaa ""
+	$xs -> str match "ab[cd]" | expect abc abd
+	$xs -> str match "a.c|x.*" | expect abc xbc a1c "a c"
+	$xs -> str match "a[0-9]?c" | expect a1c
+	$xs -> str match "a{2,}" | expect aaa
+	$xs -> str match "(ab|x)+[^d]" | expect abc
+	$xs -> str match "a*" | expect aaa ""
+	$xs -> str match "(a)\\1a" | expect aaa
+	yield aXbXc | str subst "X" "-" | expect a-b-c
+	yield abc abd | str subst "(b)(c)" "$2$1" | expect acb abd
+	{ ! yield a | str match "(" && yield OK } | expect OK
+}
+
+fun testSort {
+	b a c ab -> sort | expect a ab b c
+	10 9 -1 1.5 x -> sort -n | expect -1 x 1.5 9 10
+	a c b -> sort -r | expect c b a
+	1 01 1.0 -> sort -n | expect 01 1 1.0
+	1 01 1.0 -> sort -ns | expect 1 01 1.0
+	1 01 1.0 -> sort -nrs | expect 1 01 1.0
+	2 1 -> sort --numeric-sort --reverse | expect 2 1
+	// spills each record and merges the runs over two levels.
+	let ($xs) = [seq 4200 | /usr/bin/env sort]
+	seq 4200 | sort -S 1b | expect $xs
+	seq 200 | sort -nr -S 1b | sort -n -S 1b | expect [seq 200]
+	// left to the external command.
+	b a b -> sort -u | expect a b
+}
+
+fun testAggregates {
+	3 1 4 1 5 -> size | expect 5
+	3 1 4 1 5 -> sum | expect 14
+	3 x 4 -> sum | expect 7
+	3 1 4 1 5 -> min | expect 1
+	3 1 4 1 5 -> max | expect 5
+	{ () -> min || yield OK } | expect OK
+	0 2 02 2 1 -> uniq | expect 0 2 1
+	apple banana banana cherry -> uniq | expect apple banana cherry
+	// the usages with arguments run the external commands.
+	a a b -> uniq -c | expect "      2 a" "      1 b"
+	{ 0 0 0 -> all && 1 0 -> any && yield OK } | expect OK
+	{ 0 1 -> all || 1 1 -> any || yield OK } | expect OK
+	{ true false -> any && ! { true false -> all } && yield OK } | expect OK
+}
+
+fun testCommandHash {
+	let $dir = [mktemp -d]
+	let $path = [sys.getenv PATH]
+	mkdir $dir/p0 $dir/p1
+	printf "#!/bin/sh\necho %s\n" p0 |> $dir/foo
+	printf "#!/bin/sh\necho %s\n" p1 |> $dir/p1/foo
+	chmod +x $dir/foo $dir/p1/foo
+	sys.setenv PATH $dir"/p0:"^$dir"/p1"
+	foo | expect p1
+	// past the granularity of the mtimes.
+	/bin/sleep 0.05
+	/bin/mv $dir/foo $dir/p0/foo
+	nonexistentcmd
+	foo | expect p0
+	sys.setenv PATH $path
+	rm -r $dir
+}
+
+fun testOptions {
+	let $rish = [sh -c "readlink /proc/$PPID/exe"]
+	let $dir = [mktemp -d]
+	yield args |> $dir/args.rs
+	// the options after the script name are the script's.
+	$rish $dir/args.rs -f -j 1 -x | expect -f -j 1 -x
+	$rish -f -j 2 $dir/args.rs -j 1 | expect -j 1
+	rm -r $dir
+}
+
 fun runTest {
 	yield (1 6 + 2 1 * 3 1)
 	echo "args: " [args]
@@ -255,7 +419,18 @@ fun runTest {
 	echo [$xs -> size] #xs
 	sqrt 2000000000000
 	testHome
+	testRecords
+	testStr
+	testBuiltins
+	testCharClass
+	testTreeGlob
+	testRegex
+	testSort
+	testAggregates
+	testCommandHash
+	testOptions
 }
 
 runTest
 testStd
+($failures == 0) || return 1
@@ -2,6 +2,9 @@
 #pragma once
 
 
+// resolves the slots of variables, folds constant expressions and marks the
+// statements whose operand is statically one value without globs (single), so
+// that the evaluator can skip building and expanding lists for them.
 struct Annotator {
 	struct Local {
 		Local(): outer( nullptr ) {}
@@ -82,7 +85,20 @@ struct Annotator {
 	}
 
 	void operator()( ast::Stmt* stmt, Local& local ) {
+		fold( stmt );
 		VSWITCH( stmt ) {
+			VCASE( ast::Command, s ) {
+				ast::walk( *this, stmt, local );
+				s->single = count( s->args.get(), true ) == 1;
+			}
+			VCASE( ast::Let, s ) {
+				ast::walk( *this, stmt, local );
+				s->single = count( s->rhs.get(), true ) == 1;
+			}
+			VCASE( ast::Yield, s ) {
+				ast::walk( *this, stmt, local );
+				s->single = count( s->rhs.get(), true ) == 1;
+			}
 			VCASE( ast::Fun, s ) {
 				(*this)( s->name.get(), local );
 				Local child;
@@ -96,6 +112,156 @@ struct Annotator {
 			}
 		}
 	}
+
+	// replaces the operations on literal words by their results.  the ones
+	// which fail are left to raise the error at run time.
+	static void fold( unique_ptr<ast::Expr>& expr ) {
+		using namespace ast;
+
+		VSWITCH( expr.get() ) {
+			VCASE( Pair, e ) {
+				fold( e->lhs );
+				fold( e->rhs );
+			}
+			VCASE( Concat, e ) {
+				fold( e->lhs );
+				fold( e->rhs );
+				auto lhs = match<Word>( e->lhs.get() );
+				auto rhs = match<Word>( e->rhs.get() );
+				if( lhs && rhs ) {
+					expr = make_unique<Word>( lhs->word + rhs->word );
+				}
+			}
+			VCASE( BinOp, e ) {
+				fold( e->lhs );
+				fold( e->rhs );
+				auto lhs = match<Word>( e->lhs.get() );
+				auto rhs = match<Word>( e->rhs.get() );
+				if( lhs && rhs ) {
+					try {
+						int64_t r = apply( e->op, stoll( string( lhs->word ) ), stoll( string( rhs->word ) ) );
+						expr = make_unique<Word>( to_string( r ) );
+					}
+					catch( logic_error const& ) {
+					}
+				}
+			}
+			VCASE( UniOp, e ) {
+				fold( e->lhs );
+				if( auto lhs = match<Word>( e->lhs.get() ) ) {
+					try {
+						int64_t r = apply( e->op, stoll( string( lhs->word ) ) );
+						expr = make_unique<Word>( to_string( r ) );
+					}
+					catch( logic_error const& ) {
+					}
+				}
+			}
+			VCASE( Index, e ) {
+				fold( e->idx );
+			}
+			VCASE( Slice, e ) {
+				fold( e->bgn );
+				fold( e->end );
+			}
+			VDEFAULT {
+			}
+		}
+	}
+
+	static void fold( ast::Stmt* stmt ) {
+		using namespace ast;
+
+		VSWITCH( stmt ) {
+			VCASE( Command, s ) {
+				fold( s->args );
+			}
+			VCASE( Fun, s ) {
+				fold( s->name );
+			}
+			VCASE( FunDel, s ) {
+				fold( s->name );
+			}
+			VCASE( Let, s ) {
+				fold( s->rhs );
+			}
+			VCASE( Yield, s ) {
+				fold( s->rhs );
+			}
+			VCASE( Return, s ) {
+				fold( s->retv );
+			}
+			VCASE( Break, s ) {
+				fold( s->retv );
+			}
+			VCASE( RedirFr, s ) {
+				fold( s->file );
+			}
+			VCASE( RedirTo, s ) {
+				fold( s->file );
+			}
+			VCASE( Zip, s ) {
+				for( auto& e: s->exprs ) {
+					fold( e );
+				}
+			}
+			VCASE( Defer, s ) {
+				fold( s->args );
+			}
+			VCASE( ChDir, s ) {
+				fold( s->args );
+			}
+			VDEFAULT {
+			}
+		}
+	}
+
+	// the number of the values of the expression if it is known statically,
+	// or -1.  if plain is true, the values must also be free of globs.
+	static int count( ast::Expr* expr, bool plain ) {
+		using namespace ast;
+
+		VSWITCH( expr ) {
+			VCASE( Word, e ) {
+				return plain && e->glob ? -1 : 1;
+			}
+			VCASE( Home, _ ) {
+				return 1;
+			}
+			VCASE( Pair, e ) {
+				int lhs = count( e->lhs.get(), plain );
+				int rhs = count( e->rhs.get(), plain );
+				return lhs < 0 || rhs < 0 ? -1 : lhs + rhs;
+			}
+			VCASE( Concat, e ) {
+				int lhs = count( e->lhs.get(), plain );
+				int rhs = count( e->rhs.get(), plain );
+				return lhs < 0 || rhs < 0 ? -1 : lhs * rhs;
+			}
+			VCASE( BinOp, e ) {
+				// the operands are not expanded.
+				int lhs = count( e->lhs.get(), false );
+				int rhs = count( e->rhs.get(), false );
+				return lhs == 1 && rhs == 1 ? 1 : -1;
+			}
+			VCASE( UniOp, e ) {
+				return count( e->lhs.get(), false ) == 1 ? 1 : -1;
+			}
+			VCASE( Size, _ ) {
+				return 1;
+			}
+			VCASE( Index, e ) {
+				return count( e->idx.get(), false ) == 1 ? 1 : -1;
+			}
+			VCASE( Null, _ ) {
+				return 0;
+			}
+			VDEFAULT {
+				return -1;
+			}
+		}
+		return -1;
+	}
 };
 
 inline void annotate( ast::Stmt* s, Annotator::Local& local ) {
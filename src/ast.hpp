@@ -50,9 +50,10 @@ using Stmt = Variant<
 
 struct Word: VariantImpl<Expr, Word> {
 	Word( MetaString const& w ):
-		word( w ) {}
+		word( w ), glob( w.hasMeta() ) {}
 
 	MetaString word;
+	bool glob; // contains meta characters, i.e. needs expansion.
 };
 
 struct Home: VariantImpl<Expr, Home> {
@@ -172,9 +173,10 @@ struct If: VariantImpl<Stmt, If> {
 
 struct Command: VariantImpl<Stmt, Command> {
 	Command( unique_ptr<Expr>&& a ):
-		args( move( a ) ) {}
+		args( move( a ) ), single( false ) {}
 
 	unique_ptr<Expr> args;
+	bool single; // see Annotator.
 };
 
 struct Fun: VariantImpl<Stmt, Fun> {
@@ -196,10 +198,11 @@ struct FunDel: VariantImpl<Stmt, FunDel> {
 
 struct Let: VariantImpl<Stmt, Let> {
 	Let( unique_ptr<LeftExpr>&& l, unique_ptr<Expr>&& r ):
-		lhs( move( l ) ), rhs( move( r ) ) {}
+		lhs( move( l ) ), rhs( move( r ) ), single( false ) {}
 
 	unique_ptr<LeftExpr> lhs;
 	unique_ptr<Expr> rhs;
+	bool single; // see Annotator.
 };
 
 struct Fetch: VariantImpl<Stmt, Fetch> {
@@ -211,9 +214,10 @@ struct Fetch: VariantImpl<Stmt, Fetch> {
 
 struct Yield: VariantImpl<Stmt, Yield> {
 	Yield( unique_ptr<Expr>&& r ):
-		rhs( move( r ) ) {}
+		rhs( move( r ) ), single( false ) {}
 
 	unique_ptr<Expr> rhs;
+	bool single; // see Annotator.
 };
 
 struct Return: VariantImpl<Stmt, Return> {
@@ -315,6 +319,45 @@ struct None: VariantImpl<Stmt, None> {
 };
 
 
+// the arithmetic shared by the constant folder and the evaluator.
+inline int64_t apply( BinOp::Operator op, int64_t lhs, int64_t rhs ) {
+	switch( op ) {
+		case BinOp::add: return lhs + rhs;
+		case BinOp::sub: return lhs - rhs;
+		case BinOp::mul: return lhs * rhs;
+		case BinOp::div:
+			if( rhs == 0 ) {
+				throw invalid_argument( "" );
+			}
+			return idiv( lhs, rhs );
+		case BinOp::mod:
+			if( rhs == 0 ) {
+				throw invalid_argument( "" );
+			}
+			return imod( lhs, rhs );
+		case BinOp::eq: return (lhs == rhs) ? 0 : -1;
+		case BinOp::ne: return (lhs != rhs) ? 0 : -1;
+		case BinOp::le: return (lhs <= rhs) ? 0 : -1;
+		case BinOp::ge: return (lhs >= rhs) ? 0 : -1;
+		case BinOp::lt: return (lhs <  rhs) ? 0 : -1;
+		case BinOp::gt: return (lhs >  rhs) ? 0 : -1;
+		default:
+			assert( false );
+			return 0;
+	}
+}
+
+inline int64_t apply( UniOp::Operator op, int64_t val ) {
+	switch( op ) {
+		case UniOp::pos: return +val;
+		case UniOp::neg: return -val;
+		default:
+			assert( false );
+			return 0;
+	}
+}
+
+
 template<class Visitor, class... Args>
 void walk( Visitor& visit, Expr* expr, Args&... args ) {
 	VSWITCH( expr ) {
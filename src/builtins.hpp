@@ -2,10 +2,462 @@
 #pragma once
 
 
+// commands which run in the shell process instead of forking.  they behave
+// like the coreutils ones for the usages they support, and leave the others to
+// the external commands.
 namespace builtins {
 
 
-int setEnv( vector<string> const& args, Evaluator&, int, int ) {
+inline string resolvePath( string const& cwd, string const& path ) {
+	return path.size() != 0 && path[0] == '/' ? path : cwd + "/" + path;
+}
+
+inline void printError( string const& cmd, string const& msg ) {
+	try {
+		writeAll( 2, cmd + ": " + msg + "\n" );
+	}
+	catch( system_error const& ) {
+	}
+}
+
+// the escape sequences of "echo -e" and printf.  returns false at "\c".
+inline bool unescape( string const& src, size_t& i, string& dst, bool echo ) {
+	assert( src[i] == '\\' );
+	if( ++i == src.size() ) {
+		dst += '\\';
+		return true;
+	}
+
+	auto octal = [&]( size_t maxLen ) -> void {
+		int c = 0;
+		for( size_t n = 0; n < maxLen && i < src.size() && '0' <= src[i] && src[i] <= '7'; ++n ) {
+			c = c * 8 + (src[i++] - '0');
+		}
+		dst += char( c );
+		--i;
+	};
+
+	switch( src[i] ) {
+		case 'a':  dst += '\a';   break;
+		case 'b':  dst += '\b';   break;
+		case 'e':  dst += '\x1b'; break;
+		case 'f':  dst += '\f';   break;
+		case 'n':  dst += '\n';   break;
+		case 'r':  dst += '\r';   break;
+		case 't':  dst += '\t';   break;
+		case 'v':  dst += '\v';   break;
+		case '\\': dst += '\\';   break;
+		case 'c':
+			return false;
+		case '0':
+			if( echo ) {
+				++i;
+			}
+			octal( 3 );
+			break;
+		case '1': case '2': case '3': case '4': case '5': case '6': case '7':
+			octal( 3 );
+			break;
+		case 'x':
+			if( i + 1 < src.size() && isxdigit( uint8_t( src[i + 1] ) ) ) {
+				int c = 0;
+				for( size_t n = 0; n < 2 && i + 1 < src.size() && isxdigit( uint8_t( src[i + 1] ) ); ++n ) {
+					char h = src[++i];
+					c = c * 16 + (isdigit( uint8_t( h ) ) ? h - '0' : tolower( h ) - 'a' + 10);
+				}
+				dst += char( c );
+			}
+			else {
+				dst += "\\x";
+			}
+			break;
+		default:
+			dst += '\\';
+			dst += src[i];
+			break;
+	}
+	return true;
+}
+
+inline int true_( vector<string> const&, Evaluator&, int, int, string const& ) {
+	return 0;
+}
+
+inline int false_( vector<string> const&, Evaluator&, int, int, string const& ) {
+	return 1;
+}
+
+inline int echo( vector<string> const& args, Evaluator&, int, int ofd, string const& ) {
+	bool newline = true;
+	bool escape = false;
+	size_t i = 0;
+	for( ; i < args.size(); ++i ) {
+		string const& arg = args[i];
+		if( arg.size() < 2 || arg[0] != '-' || arg.find_first_not_of( "neE", 1 ) != string::npos ) {
+			break;
+		}
+		for( char c: arg.substr( 1 ) ) {
+			switch( c ) {
+				case 'n': newline = false; break;
+				case 'e': escape = true;   break;
+				case 'E': escape = false;  break;
+			}
+		}
+	}
+
+	string buf;
+	for( size_t j = i; j < args.size(); ++j ) {
+		if( j != i ) {
+			buf += ' ';
+		}
+		if( !escape ) {
+			buf += args[j];
+			continue;
+		}
+		string const& arg = args[j];
+		for( size_t k = 0; k < arg.size(); ++k ) {
+			if( arg[k] != '\\' ) {
+				buf += arg[k];
+			}
+			else if( !unescape( arg, k, buf, true ) ) {
+				writeAll( ofd, buf );
+				return 0;
+			}
+		}
+	}
+	if( newline ) {
+		buf += '\n';
+	}
+	writeAll( ofd, buf );
+	return 0;
+}
+
+inline int cat( vector<string> const& args, Evaluator&, int ifd, int ofd, string const& cwd ) {
+	for( auto const& arg: args ) {
+		if( arg.size() > 1 && arg[0] == '-' ) {
+			return Evaluator::Builtin::external;
+		}
+	}
+
+	auto copy = [&]( int fd ) -> void {
+		vector<char> buf( 65536 );
+		while( true ) {
+			ssize_t n;
+			{
+				Scheduler::Blocking blocking;
+				waitFd( fd, POLLIN );
+				n = read( fd, buf.data(), buf.size() );
+			}
+			checkSysCall( n );
+			if( n == 0 ) {
+				break;
+			}
+			writeAll( ofd, string( buf.data(), n ) );
+		}
+	};
+
+	if( args.size() == 0 ) {
+		copy( ifd );
+		return 0;
+	}
+
+	int retv = 0;
+	for( auto const& arg: args ) {
+		if( arg == "-" ) {
+			copy( ifd );
+			continue;
+		}
+		int fd = open( resolvePath( cwd, arg ).c_str(), O_RDONLY | O_CLOEXEC );
+		if( fd < 0 ) {
+			printError( "cat", arg + ": " + strerror( errno ) );
+			retv = 1;
+			continue;
+		}
+		auto closer = scopeExit( bind( close, fd ) );
+		copy( fd );
+	}
+	return retv;
+}
+
+// POSIX test with up to four arguments.  the longer expressions, whose
+// meanings are ambiguous, are left to the external command.
+struct Test {
+	Test( vector<string> const& a, string const& c ): args( a ), cwd( c ) {}
+
+	int operator()() {
+		switch( args.size() ) {
+			case 0:
+				return 1;
+			case 1:
+				return args[0].size() != 0 ? 0 : 1;
+			case 2:
+				if( args[0] == "!" ) {
+					return args[1].size() != 0 ? 1 : 0;
+				}
+				return unary( args[0], args[1] );
+			case 3:
+				if( isBinary( args[1] ) ) {
+					return binary( args[0], args[1], args[2] );
+				}
+				if( args[0] == "!" ) {
+					return negate( Test( { args[1], args[2] }, cwd )() );
+				}
+				if( args[0] == "(" && args[2] == ")" ) {
+					return args[1].size() != 0 ? 0 : 1;
+				}
+				return error( "too many arguments" );
+			case 4:
+				if( args[0] == "!" ) {
+					return negate( Test( { args[1], args[2], args[3] }, cwd )() );
+				}
+				if( args[0] == "(" && args[3] == ")" ) {
+					return Test( { args[1], args[2] }, cwd )();
+				}
+				return Evaluator::Builtin::external;
+			default:
+				return Evaluator::Builtin::external;
+		}
+	}
+
+	private:
+		static bool isBinary( string const& op ) {
+			static set<string> const ops = {
+				"=", "==", "!=", "<", ">", "-eq", "-ne", "-lt", "-le", "-gt", "-ge",
+				"-nt", "-ot", "-ef", "-a", "-o",
+			};
+			return ops.count( op ) != 0;
+		}
+
+		static int negate( int r ) {
+			return r == 0 ? 1 : r == 1 ? 0 : r;
+		}
+
+		static int error( string const& msg ) {
+			printError( "test", msg );
+			return 2;
+		}
+
+		static bool toInt( string const& s, int64_t& v ) {
+			size_t i = s.find_first_not_of( " \t" );
+			if( i == string::npos ) {
+				return false;
+			}
+			char* end;
+			errno = 0;
+			v = strtoll( s.c_str() + i, &end, 10 );
+			if( end == s.c_str() + i || errno != 0 ) {
+				return false;
+			}
+			return string( end ).find_first_not_of( " \t" ) == string::npos;
+		}
+
+		int unary( string const& op, string const& arg ) {
+			if( op == "-n" ) {
+				return arg.size() != 0 ? 0 : 1;
+			}
+			if( op == "-z" ) {
+				return arg.size() == 0 ? 0 : 1;
+			}
+			if( op == "-t" ) {
+				int64_t fd;
+				if( !toInt( arg, fd ) ) {
+					return error( "invalid integer '" + arg + "'" );
+				}
+				return isatty( fd ) ? 0 : 1;
+			}
+
+			string path = resolvePath( cwd, arg );
+			struct stat st;
+			bool link = op == "-h" || op == "-L";
+			if( (link ? lstat( path.c_str(), &st ) : stat( path.c_str(), &st )) < 0 ) {
+				return op.size() == 2 && op[0] == '-' && string( "bcdefghkLprsStuwxOG" ).find( op[1] ) != string::npos
+					? 1 : error( "unary operator expected" );
+			}
+			if( op == "-e" ) return 0;
+			if( op == "-f" ) return S_ISREG( st.st_mode ) ? 0 : 1;
+			if( op == "-d" ) return S_ISDIR( st.st_mode ) ? 0 : 1;
+			if( op == "-b" ) return S_ISBLK( st.st_mode ) ? 0 : 1;
+			if( op == "-c" ) return S_ISCHR( st.st_mode ) ? 0 : 1;
+			if( op == "-p" ) return S_ISFIFO( st.st_mode ) ? 0 : 1;
+			if( op == "-S" ) return S_ISSOCK( st.st_mode ) ? 0 : 1;
+			if( link )       return S_ISLNK( st.st_mode ) ? 0 : 1;
+			if( op == "-s" ) return st.st_size > 0 ? 0 : 1;
+			if( op == "-g" ) return (st.st_mode & S_ISGID) ? 0 : 1;
+			if( op == "-u" ) return (st.st_mode & S_ISUID) ? 0 : 1;
+			if( op == "-k" ) return (st.st_mode & S_ISVTX) ? 0 : 1;
+			if( op == "-O" ) return st.st_uid == geteuid() ? 0 : 1;
+			if( op == "-G" ) return st.st_gid == getegid() ? 0 : 1;
+			if( op == "-r" ) return access( path.c_str(), R_OK ) == 0 ? 0 : 1;
+			if( op == "-w" ) return access( path.c_str(), W_OK ) == 0 ? 0 : 1;
+			if( op == "-x" ) return access( path.c_str(), X_OK ) == 0 ? 0 : 1;
+			return error( "unary operator expected" );
+		}
+
+		int binary( string const& lhs, string const& op, string const& rhs ) {
+			if( op == "=" || op == "==" ) return lhs == rhs ? 0 : 1;
+			if( op == "!=" )              return lhs != rhs ? 0 : 1;
+			if( op == "<" )               return lhs <  rhs ? 0 : 1;
+			if( op == ">" )               return lhs >  rhs ? 0 : 1;
+			if( op == "-a" )              return lhs.size() != 0 && rhs.size() != 0 ? 0 : 1;
+			if( op == "-o" )              return lhs.size() != 0 || rhs.size() != 0 ? 0 : 1;
+
+			if( op == "-nt" || op == "-ot" || op == "-ef" ) {
+				struct stat ls, rs;
+				bool lok = stat( resolvePath( cwd, lhs ).c_str(), &ls ) == 0;
+				bool rok = stat( resolvePath( cwd, rhs ).c_str(), &rs ) == 0;
+				auto mtime = []( struct stat const& st ) {
+					return make_tuple( st.st_mtim.tv_sec, st.st_mtim.tv_nsec );
+				};
+				if( op == "-nt" ) return lok && (!rok || mtime( ls ) > mtime( rs )) ? 0 : 1;
+				if( op == "-ot" ) return rok && (!lok || mtime( ls ) < mtime( rs )) ? 0 : 1;
+				return lok && rok && ls.st_dev == rs.st_dev && ls.st_ino == rs.st_ino ? 0 : 1;
+			}
+
+			int64_t l, r;
+			if( !toInt( lhs, l ) ) {
+				return error( "invalid integer '" + lhs + "'" );
+			}
+			if( !toInt( rhs, r ) ) {
+				return error( "invalid integer '" + rhs + "'" );
+			}
+			if( op == "-eq" ) return l == r ? 0 : 1;
+			if( op == "-ne" ) return l != r ? 0 : 1;
+			if( op == "-lt" ) return l <  r ? 0 : 1;
+			if( op == "-le" ) return l <= r ? 0 : 1;
+			if( op == "-gt" ) return l >  r ? 0 : 1;
+			if( op == "-ge" ) return l >= r ? 0 : 1;
+			assert( false );
+			return 2;
+		}
+
+		vector<string> args;
+		string const& cwd;
+};
+
+inline int test( vector<string> const& args, Evaluator&, int, int, string const& cwd ) {
+	return Test( args, cwd )();
+}
+
+inline int bracket( vector<string> const& args, Evaluator&, int, int, string const& cwd ) {
+	if( args.size() == 0 || args.back() != "]" ) {
+		printError( "[", "missing ']'" );
+		return 2;
+	}
+	return Test( vector<string>( args.begin(), args.end() - 1 ), cwd )();
+}
+
+// supports the flags, widths and precisions of the conversions diouxXcs and
+// %%, and the escape sequences.  the others are left to the external command.
+inline int printf_( vector<string> const& args, Evaluator&, int, int ofd, string const& ) {
+	if( args.size() == 0 ) {
+		printError( "printf", "missing operand" );
+		return 1;
+	}
+
+	string const& fmt = args[0];
+	size_t argi = 1;
+	int retv = 0;
+	string buf;
+
+	auto next = [&]() -> string const* {
+		return argi < args.size() ? &args[argi++] : nullptr;
+	};
+	auto toInt = [&]( string const* arg ) -> long long {
+		if( arg == nullptr || arg->size() == 0 ) {
+			return 0;
+		}
+		if( (*arg)[0] == '\'' || (*arg)[0] == '"' ) {
+			return arg->size() > 1 ? uint8_t( (*arg)[1] ) : 0;
+		}
+		char* end;
+		errno = 0;
+		long long v = strtoll( arg->c_str(), &end, 0 );
+		if( end == arg->c_str() || *end != '\0' || errno != 0 ) {
+			printError( "printf", "'" + *arg + "': expected a numeric value" );
+			retv = 1;
+		}
+		return v;
+	};
+
+	// check the conversions first so that nothing is written on a fallback.
+	for( size_t i = 0; i < fmt.size(); ++i ) {
+		if( fmt[i] != '%' ) {
+			continue;
+		}
+		size_t j = fmt.find_first_not_of( "-+ #0123456789.", i + 1 );
+		if( j == string::npos || string( "diouxXcs%" ).find( fmt[j] ) == string::npos ) {
+			return Evaluator::Builtin::external;
+		}
+		i = j;
+	}
+
+	while( true ) {
+		size_t first = argi;
+		for( size_t i = 0; i < fmt.size(); ++i ) {
+			if( fmt[i] == '\\' ) {
+				if( !unescape( fmt, i, buf, false ) ) {
+					writeAll( ofd, buf );
+					return retv;
+				}
+				continue;
+			}
+			if( fmt[i] != '%' ) {
+				buf += fmt[i];
+				continue;
+			}
+
+			size_t j = fmt.find_first_not_of( "-+ #0123456789.", i + 1 );
+			string spec = fmt.substr( i, j - i );
+			char conv = fmt[j];
+			i = j;
+
+			array<char, 512> tmp;
+			int n = 0;
+			switch( conv ) {
+				case '%':
+					buf += '%';
+					break;
+				case 's': {
+					string const* arg = next();
+					spec += 's';
+					n = snprintf( tmp.data(), tmp.size(), spec.c_str(), arg ? arg->c_str() : "" );
+					if( n >= int( tmp.size() ) ) {
+						vector<char> big( n + 1 );
+						snprintf( big.data(), big.size(), spec.c_str(), arg ? arg->c_str() : "" );
+						buf.append( big.data(), n );
+						n = 0;
+					}
+					break;
+				}
+				case 'c': {
+					string const* arg = next();
+					spec += 'c';
+					n = snprintf( tmp.data(), tmp.size(), spec.c_str(), arg && arg->size() ? (*arg)[0] : '\0' );
+					break;
+				}
+				default:
+					spec += "ll";
+					spec += conv;
+					n = snprintf( tmp.data(), tmp.size(), spec.c_str(), toInt( next() ) );
+					break;
+			}
+			buf.append( tmp.data(), min( max( n, 0 ), int( tmp.size() ) - 1 ) );
+		}
+		// the format is reused while some arguments remain.
+		if( argi >= args.size() ) {
+			break;
+		}
+		if( argi == first ) {
+			printError( "printf", "warning: ignoring excess arguments, starting with '" + args[argi] + "'" );
+			break;
+		}
+	}
+
+	writeAll( ofd, buf );
+	return retv;
+}
+
+inline int setEnv( vector<string> const& args, Evaluator&, int, int, string const& ) {
 	if( args.size() != 2 ) {
 		return 1;
 	}
@@ -13,7 +465,7 @@ int setEnv( vector<string> const& args, Evaluator&, int, int ) {
 	return 0;
 }
 
-int getEnv( vector<string> const& args, Evaluator&, int, int ofd ) {
+inline int getEnv( vector<string> const& args, Evaluator&, int, int ofd, string const& ) {
 	if( args.size() != 1 ) {
 		return 1;
 	}
@@ -25,50 +477,732 @@ int getEnv( vector<string> const& args, Evaluator&, int, int ofd ) {
 	return 0;
 }
 
-int join( vector<string> const& args, Evaluator& eval, int, int ) {
-	static_assert( sizeof( thread::id ) == sizeof( uintptr_t ), "" );
-
+// waits for the background statements of the ids printed by "&".
+inline int join( vector<string> const& args, Evaluator& eval, int, int, string const& ) {
 	for( auto const& arg: args ) {
-		union U {
-			U() {}
-			thread::id tid;
-			uintptr_t val;
-		} u;
-		u.val = readValue<uintptr_t>( arg );
-
-		eval.mutexGlobal.lock();
-		auto it = eval.backgrounds.find( u.tid );
-		if( it != eval.backgrounds.end() ) {
-			thread thr = move( it->second );
-			eval.backgrounds.erase( it );
-			eval.mutexGlobal.unlock();
-
-			thr.join();
-		}
-		else {
-			eval.mutexGlobal.unlock();
-		}
+		eval.joinBg( stoull( arg ) );
 	}
 	return 0;
 }
 
-int wait( vector<string> const& args, Evaluator&, int, int ) {
+inline int wait( vector<string> const& args, Evaluator&, int, int, string const& ) {
 	int retv = 0;
 	for( auto const& arg: args ) {
-		pid_t pid = readValue<int>( arg );
+		pid_t pid = stoi( arg );
 		int status;
+		Scheduler::Blocking blocking;
+		waitExited( pid );
 		checkSysCall( waitpid( pid, &status, 0 ) );
 		retv = WEXITSTATUS( status );
 	}
 	return retv;
 }
 
+// writes the values in batches to amortize the output.
+struct BatchWriter {
+	BatchWriter( Output const& o, char s ): out( o ), sep( s ) {}
+
+	void put( string&& buf ) {
+		bufs.push_back( move( buf ) );
+		if( bufs.size() >= 256 ) {
+			flush();
+		}
+	}
+
+	void flush() {
+		out.put( make_move_iterator( bufs.begin() ), make_move_iterator( bufs.end() ), sep );
+		bufs.clear();
+	}
+
+	Output const& out;
+	char sep;
+	vector<string> bufs;
+};
+
+// the commands of build/str on the values of the statement.
+inline int str_( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	struct Reader {
+		bool get( string& buf ) {
+			return in.get( buf, sep, last );
+		}
+
+		bool terminated() const {
+			return last;
+		}
+
+		Input const& in;
+		char sep;
+		bool last;
+	};
+
+	Reader reader{ in, sep, true };
+	BatchWriter writer( out, sep );
+	try {
+		str::run( args, reader, writer, sep );
+	}
+	catch( invalid_argument const& ) {
+		writer.flush();
+		printError( "str", "error." );
+		return 255;
+	}
+	catch( regex_error const& ) {
+		writer.flush();
+		printError( "str", "error." );
+		return 255;
+	}
+	writer.flush();
+	return 0;
+}
+
+// the aggregations which were the loops of std.rs.  they take the values as
+// the arithmetic of rish does, and skip the values which it fails on, as the
+// statements of the loops failed.  the other exceptions are thrown as they
+// were out of the functions.  only the usages without arguments are taken
+// over; the others, e.g. "uniq -c", run the external commands of the names.
+inline int size_( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	if( args.size() != 0 ) {
+		return Evaluator::Builtin::external;
+	}
+	int64_t n = 0;
+	string buf;
+	while( in.get( buf, sep ) ) {
+		++n;
+	}
+	out.put( to_string( n ), sep );
+	return 0;
+}
+
+inline int sum( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	if( args.size() != 0 ) {
+		return Evaluator::Builtin::external;
+	}
+	int64_t s = 0;
+	string buf;
+	while( in.get( buf, sep ) ) {
+		try {
+			s = int64_t( uint64_t( s ) + uint64_t( Value::toInt( buf ) ) );
+		}
+		catch( invalid_argument const& ) {
+		}
+	}
+	out.put( to_string( s ), sep );
+	return 0;
+}
+
+// yields the least value by less, or the first one of the ties.
+template<class Less>
+int extremum( vector<string> const& args, Input const& in, Output const& out, char sep, Less less ) {
+	if( args.size() != 0 ) {
+		return Evaluator::Builtin::external;
+	}
+	string r;
+	if( !in.get( r, sep ) ) {
+		return -1;
+	}
+	string x;
+	while( in.get( x, sep ) ) {
+		try {
+			int64_t xv = Value::toInt( x );
+			if( less( xv, Value::toInt( r ) ) ) {
+				swap( r, x );
+			}
+		}
+		catch( invalid_argument const& ) {
+		}
+	}
+	out.put( r, sep );
+	return 0;
+}
+
+inline int min_( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	return extremum( args, in, out, sep, less<int64_t>() );
+}
+
+inline int max_( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	return extremum( args, in, out, sep, greater<int64_t>() );
+}
+
+// the numbers are compared as the loop of std.rs did, and the others as the
+// lines of the external uniq.
+inline bool uniqEqual( string const& x, string const& y ) {
+	try {
+		return Value::toInt( x ) == Value::toInt( y );
+	}
+	catch( invalid_argument const& ) {
+	}
+	catch( out_of_range const& ) {
+	}
+	return x == y;
+}
+
+inline int uniq( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	if( args.size() != 0 ) {
+		return Evaluator::Builtin::external;
+	}
+	BatchWriter writer( out, sep );
+	auto flusher = scopeExit( [&]() { writer.flush(); } );
+
+	string x0;
+	if( !in.get( x0, sep ) ) {
+		return 0;
+	}
+	writer.put( string( x0 ) );
+	string x1;
+	while( in.get( x1, sep ) ) {
+		if( !uniqEqual( x0, x1 ) ) {
+			writer.put( string( x1 ) );
+			swap( x0, x1 );
+		}
+	}
+	return 0;
+}
+
+// the status of "if $e" for a value, which is the integer itself or the status
+// of the command of the name.
+inline int status( string&& val, Evaluator& eval, Evaluator::Local const& local, Input const& in, Output const& out ) {
+	try {
+		return stoll( val );
+	}
+	catch( invalid_argument const& ) {
+	}
+
+	vector<string> cmd{ move( val ) };
+	try {
+		return eval.callCommand( make_move_iterator( cmd.begin() ), make_move_iterator( cmd.end() ), local, in, out );
+	}
+	catch( invalid_argument const& ) {
+		return -1;
+	}
+	catch( system_error const& ) {
+		return -2;
+	}
+}
+
+inline int all( vector<string> const& args, Evaluator& eval, Evaluator::Local const& local, Input const& in, Output const& out, char sep ) {
+	if( args.size() != 0 ) {
+		return Evaluator::Builtin::external;
+	}
+	string buf;
+	while( in.get( buf, sep ) ) {
+		if( status( move( buf ), eval, local, in, out ) != 0 ) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+inline int any( vector<string> const& args, Evaluator& eval, Evaluator::Local const& local, Input const& in, Output const& out, char sep ) {
+	if( args.size() != 0 ) {
+		return Evaluator::Builtin::external;
+	}
+	string buf;
+	while( in.get( buf, sep ) ) {
+		if( status( move( buf ), eval, local, in, out ) == 0 ) {
+			return 0;
+		}
+	}
+	return -1;
+}
+
+// sort with the options -n, -r, -s and -S of GNU sort in the C locale.  the
+// records are sorted in parallel on the scheduler and spilled to temporary
+// files beyond the memory budget.  the others, including the collations of
+// the other locales, are left to the external command.
+struct Sort {
+	Sort(): numeric( false ), reverse( false ), stable( false ), budget( defaultBudget() ) {}
+
+	// returns false for the usages which are left to the external command.
+	bool parse( vector<string> const& args ) {
+		for( size_t i = 0; i < args.size(); ++i ) {
+			string const& arg = args[i];
+			if( arg == "--numeric-sort" ) {
+				numeric = true;
+				continue;
+			}
+			if( arg == "--reverse" ) {
+				reverse = true;
+				continue;
+			}
+			if( arg == "--stable" ) {
+				stable = true;
+				continue;
+			}
+			if( arg.size() < 2 || arg[0] != '-' || arg[1] == '-' ) {
+				return false;
+			}
+			for( size_t j = 1; j < arg.size(); ++j ) {
+				switch( arg[j] ) {
+					case 'n': numeric = true; break;
+					case 'r': reverse = true; break;
+					case 's': stable  = true; break;
+					case 'S': {
+						string size = j + 1 < arg.size() ? arg.substr( j + 1 ) : ++i < args.size() ? args[i] : "";
+						if( !parseSize( size, budget ) ) {
+							return false;
+						}
+						j = arg.size();
+						break;
+					}
+					default:
+						return false;
+				}
+			}
+		}
+		return isC( "LC_COLLATE" ) && (!numeric || isC( "LC_NUMERIC" ));
+	}
+
+	int run( Input const& in, Output const& out, char sep ) const {
+		// the runs of each level, the older first.  maxRuns runs of a level
+		// are merged into a run of the next level, so that the records are
+		// rewritten once per level.
+		vector<vector<int>> levels;
+		auto closer = scopeExit( [&]() -> void {
+			for( auto& runs: levels ) {
+				for( int fd: runs ) {
+					close( fd );
+				}
+			}
+		} );
+
+		vector<string> recs;
+		size_t bytes = 0;
+		string buf;
+		while( in.get( buf, sep ) ) {
+			bytes += buf.size() + sizeof( string );
+			recs.push_back( move( buf ) );
+			if( bytes >= budget ) {
+				sortRun( recs );
+				RunWriter run;
+				for( auto& rec: recs ) {
+					run.put( move( rec ) );
+				}
+				if( levels.empty() ) {
+					levels.emplace_back();
+				}
+				levels[0].push_back( run.finish() );
+				recs.clear();
+				bytes = 0;
+
+				for( size_t l = 0; levels[l].size() >= maxRuns; ++l ) {
+					RunWriter merged;
+					merge( levels[l], recs, merged );
+					int fd = merged.finish();
+					for( int f: levels[l] ) {
+						close( f );
+					}
+					levels[l].clear();
+					if( l + 1 == levels.size() ) {
+						levels.emplace_back();
+					}
+					levels[l + 1].push_back( fd );
+				}
+			}
+		}
+		sortRun( recs );
+
+		vector<int> runs;
+		for( size_t l = levels.size(); l-- > 0; ) {
+			runs.insert( runs.end(), levels[l].begin(), levels[l].end() );
+		}
+
+		BatchWriter writer( out, sep );
+		if( runs.empty() ) {
+			for( auto& rec: recs ) {
+				writer.put( move( rec ) );
+			}
+		}
+		else {
+			merge( runs, recs, writer );
+		}
+		writer.flush();
+		return 0;
+	}
+
+	private:
+		enum { maxRuns = 64 };
+
+		// reads the records written by RunWriter.
+		struct RunReader {
+			explicit RunReader( int f ): fd( f ), buf( 1 << 18 ), bgn( 0 ), end( 0 ) {
+				checkSysCall( lseek( fd, 0, SEEK_SET ) );
+			}
+
+			bool get( string& dst ) {
+				uint64_t n;
+				if( !read( &n, sizeof( n ) ) ) {
+					return false;
+				}
+				dst.resize( n );
+				if( !read( &dst[0], n ) ) {
+					throw system_error( EIO, system_category() );
+				}
+				return true;
+			}
+
+			bool read( void* dst, size_t n ) {
+				char* it = static_cast<char*>( dst );
+				while( n > 0 ) {
+					if( bgn == end ) {
+						ssize_t r = checkSysCall( ::read( fd, buf.data(), buf.size() ) );
+						if( r == 0 ) {
+							return false;
+						}
+						bgn = 0;
+						end = max( r, ssize_t( 0 ) );
+						continue;
+					}
+					size_t m = min( n, end - bgn );
+					memcpy( it, buf.data() + bgn, m );
+					bgn += m;
+					it += m;
+					n -= m;
+				}
+				return true;
+			}
+
+			int fd;
+			vector<char> buf;
+			size_t bgn;
+			size_t end;
+		};
+
+		// writes the records to an unlinked temporary file, which is read by
+		// RunReader.
+		struct RunWriter {
+			RunWriter( RunWriter const& ) = delete;
+			RunWriter& operator=( RunWriter const& ) = delete;
+
+			RunWriter() {
+				char const* dir = getenv( "TMPDIR" );
+				string path = string( dir != nullptr && *dir != '\0' ? dir : "/tmp" ) + "/rish-sort.XXXXXX";
+				fd = checkSysCall( mkostemp( &path[0], O_CLOEXEC ) );
+				unlink( path.c_str() );
+			}
+
+			~RunWriter() {
+				if( fd >= 0 ) {
+					close( fd );
+				}
+			}
+
+			void put( string&& rec ) {
+				uint64_t n = rec.size();
+				buf.append( reinterpret_cast<char const*>( &n ), sizeof( n ) );
+				buf += rec;
+				if( buf.size() >= 1 << 20 ) {
+					writeAll( fd, buf );
+					buf.clear();
+				}
+			}
+
+			// returns the fd, which the caller owns.
+			int finish() {
+				writeAll( fd, buf );
+				buf.clear();
+				int f = fd;
+				fd = -1;
+				return f;
+			}
+
+			int fd;
+			string buf;
+		};
+
+		// the number of GNU sort -n: blanks, an optional minus, the integer and
+		// the fraction.  the others are zero.
+		struct Number {
+			explicit Number( string const& s ) {
+				char const* it = s.c_str();
+				while( *it == ' ' || *it == '\t' || *it == '\n' ) {
+					++it;
+				}
+				bool neg = *it == '-';
+				if( neg ) {
+					++it;
+				}
+				while( *it == '0' ) {
+					++it;
+				}
+				intB = it;
+				while( isdigit( uint8_t( *it ) ) ) {
+					++it;
+				}
+				intE = it;
+				fracB = fracE = it;
+				if( *it == '.' ) {
+					fracB = ++it;
+					while( isdigit( uint8_t( *it ) ) ) {
+						++it;
+					}
+					fracE = it;
+					while( fracE != fracB && fracE[-1] == '0' ) {
+						--fracE;
+					}
+				}
+				sign = intB == intE && fracB == fracE ? 0 : neg ? -1 : +1;
+			}
+
+			int sign;
+			char const* intB;
+			char const* intE;
+			char const* fracB;
+			char const* fracE;
+		};
+
+		static int numCompare( string const& a, string const& b ) {
+			Number x( a );
+			Number y( b );
+			if( x.sign != y.sign ) {
+				return x.sign < y.sign ? -1 : +1;
+			}
+
+			int c = 0;
+			if( x.intE - x.intB != y.intE - y.intB ) {
+				c = x.intE - x.intB < y.intE - y.intB ? -1 : +1;
+			}
+			else if( int d = memcmp( x.intB, y.intB, x.intE - x.intB ) ) {
+				c = d;
+			}
+			else {
+				size_t xn = x.fracE - x.fracB;
+				size_t yn = y.fracE - y.fracB;
+				int e = memcmp( x.fracB, y.fracB, min( xn, yn ) );
+				c = e != 0 ? e : xn < yn ? -1 : xn > yn ? +1 : 0;
+			}
+			return x.sign * (c < 0 ? -1 : c > 0 ? +1 : 0);
+		}
+
+		// the comparison of GNU sort: the key, and then the whole record
+		// unless the sort is stable.
+		int compare( string const& a, string const& b ) const {
+			int c = numeric ? numCompare( a, b ) : 0;
+			if( c == 0 && !(numeric && stable) ) {
+				c = a.compare( b );
+				c = c < 0 ? -1 : c > 0 ? +1 : 0;
+			}
+			return reverse ? -c : c;
+		}
+
+		// runs f( i ) for i in [0, n) on the scheduler.
+		template<class Func>
+		static void parallelFor( size_t n, Func const& f ) {
+			vector<shared_ptr<Scheduler::Task>> tasks;
+			for( size_t i = 1; i < n; ++i ) {
+				tasks.push_back( Scheduler::instance().spawn( [&f, i]() -> void {
+					f( i );
+				} ) );
+			}
+			if( n > 0 ) {
+				f( 0 );
+			}
+			for( auto& task: tasks ) {
+				task->join();
+			}
+		}
+
+		// a sample sort.  the records are distributed stably to the buckets
+		// between the splitters, which are sorted concurrently.
+		void sortRun( vector<string>& recs ) const {
+			auto less = [this]( string const& a, string const& b ) -> bool {
+				return compare( a, b ) < 0;
+			};
+			auto sortRange = [&]( vector<string>::iterator bgn, vector<string>::iterator end ) -> void {
+				if( numeric && stable ) {
+					stable_sort( bgn, end, less );
+				}
+				else {
+					sort( bgn, end, less );
+				}
+			};
+
+			size_t const n = recs.size();
+			size_t const nThreads = max( thread::hardware_concurrency(), 1u );
+			if( nThreads == 1 || n < 1 << 16 ) {
+				sortRange( recs.begin(), recs.end() );
+				return;
+			}
+
+			size_t const nBuckets = nThreads * 4;
+			vector<string> sample;
+			size_t const step = max( n / (nBuckets * 32), size_t( 1 ) );
+			for( size_t i = 0; i < n; i += step ) {
+				sample.push_back( recs[i] );
+			}
+			sort( sample.begin(), sample.end(), less );
+			vector<string> splitters;
+			for( size_t i = 1; i < nBuckets; ++i ) {
+				splitters.push_back( move( sample[i * sample.size() / nBuckets] ) );
+			}
+
+			size_t const nChunks = nThreads;
+			auto chunk = [&]( size_t i ) -> size_t {
+				return n * i / nChunks;
+			};
+			vector<uint32_t> ids( n );
+			vector<vector<size_t>> offsets( nChunks, vector<size_t>( nBuckets ) );
+			parallelFor( nChunks, [&]( size_t c ) -> void {
+				for( size_t i = chunk( c ); i < chunk( c + 1 ); ++i ) {
+					ids[i] = upper_bound( splitters.begin(), splitters.end(), recs[i], less ) - splitters.begin();
+					++offsets[c][ids[i]];
+				}
+			} );
+
+			vector<size_t> bounds( nBuckets + 1 );
+			size_t pos = 0;
+			for( size_t b = 0; b < nBuckets; ++b ) {
+				bounds[b] = pos;
+				for( size_t c = 0; c < nChunks; ++c ) {
+					size_t count = offsets[c][b];
+					offsets[c][b] = pos;
+					pos += count;
+				}
+			}
+			bounds[nBuckets] = n;
+
+			vector<string> dst( n );
+			parallelFor( nChunks, [&]( size_t c ) -> void {
+				for( size_t i = chunk( c ); i < chunk( c + 1 ); ++i ) {
+					dst[offsets[c][ids[i]]++] = move( recs[i] );
+				}
+			} );
+			parallelFor( nBuckets, [&]( size_t b ) -> void {
+				sortRange( dst.begin() + bounds[b], dst.begin() + bounds[b + 1] );
+			} );
+			recs.swap( dst );
+		}
+
+		// merges the runs and the last records, which are the latest, keeping
+		// the order of the equal records.
+		template<class Writer>
+		void merge( vector<int> const& runs, vector<string>& recs, Writer& writer ) const {
+			vector<RunReader> readers;
+			for( int fd: runs ) {
+				readers.emplace_back( fd );
+			}
+			size_t const nSources = readers.size() + 1;
+			vector<string> heads( nSources );
+			size_t last = 0;
+			auto next = [&]( size_t i ) -> bool {
+				if( i < readers.size() ) {
+					return readers[i].get( heads[i] );
+				}
+				if( last < recs.size() ) {
+					heads[i] = move( recs[last++] );
+					return true;
+				}
+				return false;
+			};
+
+			auto after = [&]( size_t i, size_t j ) -> bool {
+				int c = compare( heads[i], heads[j] );
+				return c != 0 ? c > 0 : i > j;
+			};
+			vector<size_t> heap;
+			for( size_t i = 0; i < nSources; ++i ) {
+				if( next( i ) ) {
+					heap.push_back( i );
+				}
+			}
+			make_heap( heap.begin(), heap.end(), after );
+			while( !heap.empty() ) {
+				pop_heap( heap.begin(), heap.end(), after );
+				size_t i = heap.back();
+				writer.put( move( heads[i] ) );
+				if( next( i ) ) {
+					push_heap( heap.begin(), heap.end(), after );
+				}
+				else {
+					heap.pop_back();
+				}
+			}
+		}
+
+		// the sizes of -S: the number with a suffix of b, K, M, G or T.  the
+		// default unit is KiB as GNU sort.
+		static bool parseSize( string const& src, size_t& dst ) {
+			char* end;
+			errno = 0;
+			unsigned long long n = strtoull( src.c_str(), &end, 10 );
+			if( end == src.c_str() || !isdigit( uint8_t( src[0] ) ) || errno != 0 ) {
+				return false;
+			}
+			string suffix( end );
+			size_t const units[] = { 1, 1 << 10, 1 << 20, 1 << 30, size_t( 1 ) << 40 };
+			size_t const idx = (
+				suffix == "b"                    ? 0 :
+				suffix == ""  || suffix == "K" || suffix == "k" ? 1 :
+				suffix == "M"                    ? 2 :
+				suffix == "G"                    ? 3 :
+				suffix == "T"                    ? 4 :
+				                                   size( units )
+			);
+			if( idx == size( units ) ) {
+				return false;
+			}
+			dst = max( size_t( n ) * units[idx], size_t( 1 ) );
+			return true;
+		}
+
+		static size_t defaultBudget() {
+			long pages = sysconf( _SC_PHYS_PAGES );
+			long pageSize = sysconf( _SC_PAGESIZE );
+			size_t phys = pages > 0 && pageSize > 0 ? size_t( pages ) * pageSize : 0;
+			return max( phys / 8, size_t( 1 ) << 26 );
+		}
+
+		// whether the category of the locale is C or POSIX, where the bytes
+		// are compared as they are.
+		static bool isC( char const* category ) {
+			char const* name = nullptr;
+			for( char const* var: { "LC_ALL", category, "LANG" } ) {
+				name = getenv( var );
+				if( name != nullptr && *name != '\0' ) {
+					break;
+				}
+			}
+			if( name == nullptr || *name == '\0' ) {
+				return true;
+			}
+			string s( name );
+			return s == "C" || s == "POSIX" || s.compare( 0, 2, "C." ) == 0;
+		}
+
+		bool numeric;
+		bool reverse;
+		bool stable;
+		size_t budget;
+};
+
+inline int sort_( vector<string> const& args, Evaluator&, Evaluator::Local const&, Input const& in, Output const& out, char sep ) {
+	Sort sort;
+	if( !sort.parse( args ) ) {
+		return Evaluator::Builtin::external;
+	}
+	return sort.run( in, out, sep );
+}
+
 template<class Map>
 void register_( Map& map ) {
-	map["sys.setenv"] = setEnv;
-	map["sys.getenv"] = getEnv;
-	map["sys.join"] = join;
-	map["sys.wait"] = wait;
+	map["true"]       = { true_,   false, nullptr };
+	map["false"]      = { false_,  false, nullptr };
+	map["echo"]       = { echo,    false, nullptr };
+	map["cat"]        = { cat,     true,  nullptr };
+	map["test"]       = { test,    false, nullptr };
+	map["["]          = { bracket, false, nullptr };
+	map["printf"]     = { printf_, false, nullptr };
+	map["sys.setenv"] = { setEnv,  false, nullptr };
+	map["sys.getenv"] = { getEnv,  false, nullptr };
+	map["sys.join"]   = { join,    false, nullptr };
+	map["sys.wait"]   = { wait,    false, nullptr };
+	map["str"]        = { nullptr, false, str_    };
+	map["size"]       = { nullptr, false, size_   };
+	map["sum"]        = { nullptr, false, sum     };
+	map["min"]        = { nullptr, false, min_    };
+	map["max"]        = { nullptr, false, max_    };
+	map["uniq"]       = { nullptr, false, uniq    };
+	map["all"]        = { nullptr, false, all     };
+	map["any"]        = { nullptr, false, any     };
+	map["sort"]       = { nullptr, false, sort_   };
 }
 
 
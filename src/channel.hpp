@@ -0,0 +1,481 @@
+// (c) Yasuhiro Fujii <y-fujii at mimosa-pudica.net> / 2-clause BSD license
+#pragma once
+
+
+// bounded in-process queue which carries values between rish stages without
+// serializing them through a kernel pipe.
+struct Channel {
+	explicit Channel( size_t cap = 256 ):
+		_cap( cap ), _rclosed( false ), _wclosed( false ) {
+	}
+
+	// returns false iff the reader has gone.
+	template<class Iter>
+	bool put( Iter bgn, Iter end ) {
+		unique_lock<mutex> lock( _mutex );
+		while( bgn != end ) {
+			if( _queue.size() >= _cap && !_rclosed ) {
+				Scheduler::Blocking blocking;
+				_wcond.wait( lock, [&]() { return _queue.size() < _cap || _rclosed; } );
+			}
+			if( _rclosed ) {
+				return false;
+			}
+			while( bgn != end && _queue.size() < _cap ) {
+				_queue.push_back( *bgn++ );
+				if( !_partial.empty() ) {
+					_queue.back().insert( 0, _partial );
+					_partial.clear();
+				}
+			}
+			_rcond.notify_one();
+		}
+		return true;
+	}
+
+	bool put( string&& v ) {
+		return put( make_move_iterator( &v ), make_move_iterator( &v + 1 ) );
+	}
+
+	// keeps the unterminated tail of a byte stream, which is joined to the
+	// next value as a pipe would.
+	void putPartial( string const& v ) {
+		lock_guard<mutex> lock( _mutex );
+		_partial += v;
+	}
+
+	// returns false iff the writer has gone and the queue is empty.
+	bool get( string& v ) {
+		unique_lock<mutex> lock( _mutex );
+		if( _queue.empty() && !_wclosed ) {
+			Scheduler::Blocking blocking;
+			_rcond.wait( lock, [&]() { return !_queue.empty() || _wclosed; } );
+		}
+		return _pop( v );
+	}
+
+	// same as get(), but gives up when *cancel is set and wake() is called.
+	bool get( string& v, atomic<bool> const& cancel ) {
+		unique_lock<mutex> lock( _mutex );
+		_rcond.wait( lock, [&]() { return !_queue.empty() || _wclosed || cancel; } );
+		return !cancel && _pop( v );
+	}
+
+	// pushes values back to the front of the queue.
+	template<class Iter>
+	void unget( Iter bgn, Iter end ) {
+		lock_guard<mutex> lock( _mutex );
+		_queue.insert( _queue.begin(), bgn, end );
+		_rcond.notify_all();
+	}
+
+	void wake() {
+		lock_guard<mutex> lock( _mutex );
+		_rcond.notify_all();
+		_wcond.notify_all();
+	}
+
+	void closeWriter() {
+		lock_guard<mutex> lock( _mutex );
+		if( !_partial.empty() ) {
+			_queue.push_back( move( _partial ) );
+			_partial.clear();
+		}
+		_wclosed = true;
+		_rcond.notify_all();
+	}
+
+	void closeReader() {
+		lock_guard<mutex> lock( _mutex );
+		_rclosed = true;
+		_queue.clear();
+		_partial.clear();
+		_wcond.notify_all();
+	}
+
+	private:
+		bool _pop( string& v ) {
+			if( _queue.empty() ) {
+				return false;
+			}
+			v = move( _queue.front() );
+			_queue.pop_front();
+			_wcond.notify_one();
+			return true;
+		}
+
+		size_t const       _cap;
+		bool               _rclosed;
+		bool               _wclosed;
+		deque<string>      _queue;
+		string             _partial;
+		mutex              _mutex;
+		CondVar            _rcond;
+		CondVar            _wcond;
+};
+
+// the input of a statement: a file descriptor or an in-process channel.  the
+// reader of a file descriptor is shared by all the statements which read it.
+struct Input {
+	explicit Input( int f, size_t block = 1 << 16 ): fd( f ), reader( make_shared<RecordReader>( f, block ) ) {}
+	Input( shared_ptr<Channel> c ): fd( -1 ), chan( move( c ) ) {}
+
+	bool get( string& v, char sep ) const {
+		return chan ? chan->get( v ) : reader->get( v, sep );
+	}
+
+	// values of a channel are always taken as terminated.
+	bool get( string& v, char sep, bool& terminated ) const {
+		terminated = true;
+		return chan ? chan->get( v ) : reader->get( v, sep, terminated );
+	}
+
+	void close() const {
+		if( chan ) {
+			chan->closeReader();
+		}
+		else {
+			::close( fd );
+		}
+	}
+
+	int fd;
+	shared_ptr<Channel> chan;
+	shared_ptr<RecordReader> reader;
+};
+
+// the output of a statement: a file descriptor or an in-process channel.
+struct Output {
+	Output( int f ): fd( f ) {}
+	Output( shared_ptr<Channel> c ): fd( -1 ), chan( move( c ) ) {}
+
+	template<class Iter>
+	void put( Iter bgn, Iter end, char sep ) const {
+		if( chan ) {
+			// a value which contains the separator is split into the records
+			// which a pipe would carry.
+			bool split = false;
+			for( Iter it = bgn; it != end && !split; ++it ) {
+				split = (*it).find( sep ) != string::npos;
+			}
+			bool alive;
+			if( split ) {
+				vector<string> vals;
+				for( Iter it = bgn; it != end; ++it ) {
+					auto&& v = *it;
+					size_t i = 0;
+					while( true ) {
+						size_t j = v.find( sep, i );
+						if( j == string::npos ) {
+							vals.push_back( v.substr( i ) );
+							break;
+						}
+						vals.push_back( v.substr( i, j - i ) );
+						i = j + 1;
+					}
+				}
+				alive = chan->put( make_move_iterator( vals.begin() ), make_move_iterator( vals.end() ) );
+			}
+			else {
+				alive = chan->put( bgn, end );
+			}
+			if( !alive ) {
+				throw system_error( EPIPE, system_category() );
+			}
+		}
+		else {
+			// small values are gathered into a buffer with the separators and
+			// large ones are written in place by writev().
+			size_t const large = 4096;
+			size_t size = 0;
+			for( Iter it = bgn; it != end && size < 1 << 16; ++it ) {
+				size += (*it).size() < large ? (*it).size() + 1 : 1;
+			}
+			// sized to the data and left uninitialized, since most puts are small.
+			size = min( size, size_t( 1 ) << 16 );
+			unique_ptr<char[]> buf( new char[size] );
+			vector<iovec> iov;
+			size_t used = 0;
+			auto append = [&]( char const* p, size_t n ) -> void {
+				if( iov.empty() || static_cast<char*>( iov.back().iov_base ) + iov.back().iov_len != &buf[used] ) {
+					iov.push_back( iovec{ &buf[used], 0 } );
+				}
+				memcpy( &buf[used], p, n );
+				iov.back().iov_len += n;
+				used += n;
+			};
+
+			for( Iter it = bgn; it != end; ++it ) {
+				auto&& v = *it;
+				size_t n = v.size() < large ? v.size() + 1 : 1;
+				if( used + n > size || iov.size() + 2 > size_t( IOV_MAX ) ) {
+					writeAll( fd, iov.data(), iov.size() );
+					iov.clear();
+					used = 0;
+				}
+				if( v.size() < large ) {
+					append( v.data(), v.size() );
+				}
+				else {
+					iov.push_back( iovec{ const_cast<char*>( v.data() ), v.size() } );
+				}
+				append( &sep, 1 );
+			}
+			writeAll( fd, iov.data(), iov.size() );
+		}
+	}
+
+	void put( string const& v, char sep ) const {
+		put( &v, &v + 1, sep );
+	}
+
+	void close() const {
+		if( chan ) {
+			chan->closeWriter();
+		}
+		else {
+			::close( fd );
+		}
+	}
+
+	int fd;
+	shared_ptr<Channel> chan;
+};
+
+// provides a readable file descriptor of an Input for external processes.  if
+// the input is a channel or the data have been read ahead, they are pumped
+// into a pipe by a thread while the consumer runs.  the data which have not
+// been read by the consumer are put back, so that the input behaves like a
+// plain file descriptor.
+struct InputFd {
+	InputFd( InputFd const& ) = delete;
+	InputFd& operator=( InputFd const& ) = delete;
+
+	InputFd( Input const& in, char sep ):
+		_chan( in.chan ), _fd( in.fd ), _sep( sep ), _cancel( false ) {
+		if( !_chan ) {
+			if( in.reader->seekBack() ) {
+				return;
+			}
+			_reader = in.reader;
+		}
+
+		int fds[2];
+		checkSysCall( pipe( fds ) );
+		_fd = fds[0];
+		_ofd = fds[1];
+		checkSysCall( fcntl( _ofd, F_SETFL, O_NONBLOCK ) );
+		checkSysCall( pipe( _wakeFds ) );
+		_pump = thread( [this]() -> void {
+			_run();
+			_finished.set();
+		} );
+	}
+
+	~InputFd() {
+		if( !_pump.joinable() ) {
+			return;
+		}
+
+		_cancel = true;
+		if( _chan ) {
+			_chan->wake();
+		}
+		uint8_t dummy = 0;
+		if( write( _wakeFds[1], &dummy, 1 ) < 0 ) {
+			terminate();
+		}
+		{
+			Scheduler::Blocking blocking;
+			_finished.wait();
+		}
+		_pump.join();
+
+		// collect the data left in the pipe.
+		string rest;
+		fcntl( _fd, F_SETFL, O_NONBLOCK );
+		while( true ) {
+			char buf[PIPE_BUF];
+			ssize_t n = read( _fd, buf, sizeof( buf ) );
+			if( n <= 0 ) {
+				break;
+			}
+			rest.append( buf, n );
+		}
+		rest += _unwritten;
+
+		if( _ofd >= 0 ) {
+			close( _ofd );
+		}
+		close( _fd );
+		close( _wakeFds[0] );
+		close( _wakeFds[1] );
+
+		if( _reader ) {
+			_reader->unget( rest );
+			return;
+		}
+
+		vector<string> vals;
+		size_t i = 0;
+		while( i < rest.size() ) {
+			size_t j = rest.find( _sep, i );
+			if( j == string::npos ) {
+				j = rest.size();
+			}
+			vals.push_back( rest.substr( i, j - i ) );
+			i = j + 1;
+		}
+		_chan->unget( make_move_iterator( vals.begin() ), make_move_iterator( vals.end() ) );
+	}
+
+	int get() const {
+		return _fd;
+	}
+
+	private:
+		// returns false iff the source has been exhausted or cancelled.
+		bool _next( string& buf ) {
+			if( _chan ) {
+				if( !_chan->get( buf, _cancel ) ) {
+					return false;
+				}
+				buf += _sep;
+				return true;
+			}
+
+			buf = _reader->takeBuffered();
+			if( !buf.empty() ) {
+				return true;
+			}
+			while( true ) {
+				pollfd pfds[] = {
+					{ _reader->fd(), POLLIN, 0 },
+					{ _wakeFds[0], POLLIN, 0 },
+				};
+				if( poll( pfds, ::size( pfds ), -1 ) < 0 && errno != EINTR ) {
+					terminate();
+				}
+				if( pfds[1].revents & POLLIN ) {
+					return false;
+				}
+				if( pfds[0].revents != 0 ) {
+					break;
+				}
+			}
+			buf.resize( PIPE_BUF );
+			ssize_t n = read( _reader->fd(), &buf[0], buf.size() );
+			buf.resize( max<ssize_t>( n, 0 ) );
+			return n > 0;
+		}
+
+		void _run() {
+			string buf;
+			while( _next( buf ) ) {
+				size_t i = 0;
+				while( i < buf.size() ) {
+					pollfd pfds[] = {
+						{ _ofd, POLLOUT, 0 },
+						{ _wakeFds[0], POLLIN, 0 },
+					};
+					if( poll( pfds, ::size( pfds ), -1 ) < 0 && errno != EINTR ) {
+						terminate();
+					}
+					if( pfds[1].revents & POLLIN ) {
+						_unwritten = buf.substr( i );
+						return;
+					}
+					ssize_t n = write( _ofd, buf.data() + i, buf.size() - i );
+					if( n < 0 ) {
+						if( errno == EAGAIN || errno == EINTR ) {
+							continue;
+						}
+						// the consumer has gone.
+						_unwritten = buf.substr( i );
+						return;
+					}
+					i += n;
+				}
+			}
+
+			// the source has been exhausted; let the consumer see EOF.
+			if( !_cancel ) {
+				close( _ofd );
+				_ofd = -1;
+			}
+		}
+
+		shared_ptr<Channel> _chan;
+		shared_ptr<RecordReader> _reader;
+		int _fd;
+		int _ofd;
+		int _wakeFds[2];
+		char const _sep;
+		atomic<bool> _cancel;
+		string _unwritten;
+		Latch _finished;
+		thread _pump;
+};
+
+// provides a writable file descriptor of an Output for external processes.  if
+// the output is a channel, the data written to a pipe are split into values
+// by a thread.
+struct OutputFd {
+	OutputFd( OutputFd const& ) = delete;
+	OutputFd& operator=( OutputFd const& ) = delete;
+
+	OutputFd( Output const& out, char sep ):
+		_chan( out.chan ), _fd( out.fd ) {
+		if( !_chan ) {
+			return;
+		}
+
+		int fds[2];
+		checkSysCall( pipe( fds ) );
+		_fd = fds[1];
+		int ifd = fds[0];
+		_pump = thread( [this, ifd, sep]() -> void {
+			auto closer = scopeExit( bind( close, ifd ) );
+			try {
+				RecordReader reader( ifd );
+				string buf;
+				bool terminated;
+				while( reader.get( buf, sep, terminated ) ) {
+					if( !terminated ) {
+						_chan->putPartial( buf );
+						break;
+					}
+					if( !_chan->put( move( buf ) ) ) {
+						break;
+					}
+				}
+			}
+			catch( system_error const& ) {
+			}
+			_finished.set();
+		} );
+	}
+
+	~OutputFd() {
+		if( !_chan ) {
+			return;
+		}
+
+		close( _fd );
+		{
+			Scheduler::Blocking blocking;
+			_finished.wait();
+		}
+		_pump.join();
+	}
+
+	int get() const {
+		return _fd;
+	}
+
+	private:
+		shared_ptr<Channel> _chan;
+		int _fd;
+		Latch _finished;
+		thread _pump;
+};
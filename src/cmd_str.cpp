@@ -2,139 +2,399 @@
 
 #include "pch.hpp"
 #include "misc.hpp"
+#include "regex.hpp"
+#include "str.hpp"
 
 
-void cmdChars( char**, int ) {
-	char c;
-	while( cin.read( &c, 1 ) ) {
-		cout << c << '\n';
+// reads the lines of stdin in large blocks.  the lines are searched by
+// memchr(), which is vectorized by libc.
+struct StdIn {
+	StdIn(): _buf( 1 << 20 ), _bgn( 0 ), _scan( 0 ), _end( 0 ), _eof( false ), _terminated( true ) {}
+
+	// the next line without the newline, which is valid until the next call.
+	bool get( char const*& line, size_t& size ) {
+		while( true ) {
+			char* bgn = _buf.data() + _bgn;
+			if( auto it = static_cast<char*>( memchr( _buf.data() + _scan, '\n', _end - _scan ) ) ) {
+				line = bgn;
+				size = it - bgn;
+				_bgn = _scan = it - _buf.data() + 1;
+				_terminated = true;
+				return true;
+			}
+			_scan = _end;
+
+			if( _eof ) {
+				// same as getline(), the last line may lack the newline.
+				if( _bgn == _end ) {
+					return false;
+				}
+				line = bgn;
+				size = _end - _bgn;
+				_bgn = _end;
+				_terminated = false;
+				return true;
+			}
+			_fill();
+		}
 	}
-}
 
-void cmdJoin( char**, int ) {
-	string buf;
-	while( getline( cin, buf ) ) {
-		cout << buf;
+	bool get( string& buf ) {
+		char const* line;
+		size_t size;
+		if( !get( line, size ) ) {
+			return false;
+		}
+		buf.assign( line, size );
+		return true;
 	}
-	cout << '\n';
-}
 
-void cmdLen( char**, int ) {
-	string buf;
-	while( getline( cin, buf ) ) {
-		cout << buf.size() << '\n';
+	// whether the last line had the newline.
+	bool terminated() const {
+		return _terminated;
 	}
-}
 
-void cmdIndex( char** arg, int argc ) {
-	vector<int64_t> idx( argc );
-	for( int i = 0; i < argc; ++i ) {
-		idx[i] = strtoll( arg[i], nullptr, 10 );
+	private:
+		// moves the partial line to the front and reads after it.  the buffer
+		// grows for the lines longer than it.
+		void _fill() {
+			size_t rest = _end - _bgn;
+			memmove( _buf.data(), _buf.data() + _bgn, rest );
+			_scan -= _bgn;
+			_bgn = 0;
+			_end = rest;
+			if( _end == _buf.size() ) {
+				_buf.resize( _buf.size() * 2 );
+			}
+
+			ssize_t n;
+			do {
+				n = read( 0, _buf.data() + _end, _buf.size() - _end );
+			} while( n < 0 && errno == EINTR );
+			if( n < 0 ) {
+				throw system_error( errno, system_category() );
+			}
+			_end += n;
+			_eof = n == 0;
+		}
+
+		vector<char> _buf;
+		size_t _bgn;
+		size_t _scan;
+		size_t _end;
+		bool _eof;
+		bool _terminated;
+};
+
+// gathers the output and writes it to stdout in large blocks.
+struct StdOut {
+	StdOut() {
+		_buf.reserve( capacity );
+	}
+
+	void put( string&& buf ) {
+		write( buf.data(), buf.size() );
+		write( "\n", 1 );
 	}
 
-	string buf;
-	while( getline( cin, buf ) ) {
-		for( int64_t i: idx ) {
-			if( buf.size() == 0 ) {
-				throw exception();
+	void write( char const* src, size_t size ) {
+		if( _buf.size() + size > capacity ) {
+			flush();
+			if( size >= capacity ) {
+				_write( src, size );
+				return;
 			}
-			int64_t j = imod( i, buf.size() );
-			cout << buf[j] << '\n';
 		}
+		_buf.append( src, size );
+	}
+
+	void flush() {
+		_write( _buf.data(), _buf.size() );
+		_buf.clear();
 	}
-}
 
-void cmdSlice( char** arg, int ) {
-	int64_t bgn = strtoll( arg[0], nullptr, 10 );
-	int64_t end = strtoll( arg[1], nullptr, 10 );
+	private:
+		enum { capacity = 1 << 20 };
 
-	string buf;
-	while( getline( cin, buf ) ) {
-		int64_t b = imod( bgn, buf.size() );
-		int64_t e = imod( end, buf.size() );
-		if( b > e ) {
-			throw exception();
+		static void _write( char const* src, size_t size ) {
+			while( size > 0 ) {
+				ssize_t n = ::write( 1, src, size );
+				if( n < 0 ) {
+					if( errno == EINTR ) {
+						continue;
+					}
+					throw system_error( errno, system_category() );
+				}
+				src += n;
+				size -= n;
+			}
 		}
-		cout << buf.substr( b, e - b ) << '\n';
+
+		string _buf;
+};
+
+// "len" and "join" on the buffers, without copying the lines.
+void lenLines( StdIn& in, StdOut& out ) {
+	char const* line;
+	size_t size;
+	while( in.get( line, size ) ) {
+		char buf[24];
+		char* it = end( buf );
+		*--it = '\n';
+		do {
+			*--it = '0' + size % 10;
+			size /= 10;
+		} while( size > 0 );
+		out.write( it, end( buf ) - it );
 	}
 }
 
-void cmdCmp( char** arg, int ) {
-	string src( arg[0] );
-
-	string buf;
-	while( getline( cin, buf ) ) {
-		int t = (
-			buf < src ? -1 :
-			buf > src ? +1 :
-						 0
-		);
-		cout << t << '\n';
+void joinLines( StdIn& in, StdOut& out ) {
+	char const* line;
+	size_t size;
+	while( in.get( line, size ) ) {
+		out.write( line, size );
 	}
+	out.write( "\n", 1 );
 }
 
-void cmdMatch( char** arg, int ) {
-	regex re( arg[0] );
-	string buf;
-	while( getline( cin, buf ) ) {
-		if( regex_match( buf, re ) ) {
-			cout << buf << '\n';
+// the lines of a block of memory.
+struct MemIn {
+	MemIn( char const* b, char const* e ): _bgn( b ), _end( e ), _terminated( true ) {}
+
+	bool get( string& buf ) {
+		if( _bgn == _end ) {
+			return false;
 		}
+		auto it = static_cast<char const*>( memchr( _bgn, '\n', _end - _bgn ) );
+		char const* e = it != nullptr ? it : _end;
+		buf.assign( _bgn, e );
+		_bgn = it != nullptr ? it + 1 : _end;
+		_terminated = it != nullptr;
+		return true;
 	}
-}
 
-void cmdSubst( char** arg, int ) {
-	regex re( arg[0] );
-	string buf;
-	while( getline( cin, buf ) ) {
-		cout << regex_replace( buf, re, arg[1] ) << '\n';
+	bool terminated() const {
+		return _terminated;
 	}
-}
 
-struct Command {
-	string name;
-	int arity;
-	function<void( char**, int )> func;
+	private:
+		char const* _bgn;
+		char const* _end;
+		bool _terminated;
 };
 
-array<Command, 8> commands = {{
-	{ "chars",  0, &cmdChars },
-	{ "join" ,  0, &cmdJoin  },
-	{ "len"  ,  0, &cmdLen   },
-	{ "index", -1, &cmdIndex },
-	{ "slice",  2, &cmdSlice },
-	{ "cmp"  ,  1, &cmdCmp   },
-	{ "match",  1, &cmdMatch },
-	{ "subst",  2, &cmdSubst },
-}};
+struct MemOut {
+	void put( string&& buf ) {
+		dst += buf;
+		dst += '\n';
+	}
 
-int main( int argc, char** argv ) {
-	try {
-		int opt;
-		while( opt = getopt( argc, argv, "" ), opt != -1 ) {
-			throw exception();
+	string dst;
+};
+
+// splits stdin into the blocks of whole lines, which are read ahead into the
+// blocks while the former blocks are processed.  regular files are read as
+// pipes, not mapped, since a file truncated meanwhile would raise SIGBUS.
+struct Chunker {
+	Chunker(): _eof( false ) {
+		struct stat st;
+		if( fstat( 0, &st ) == 0 && S_ISREG( st.st_mode ) ) {
+			posix_fadvise( 0, 0, 0, POSIX_FADV_SEQUENTIAL );
 		}
-		if( optind >= argc ) {
-			throw exception();
+	}
+
+	bool next( string& buf ) {
+		buf.swap( _rest );
+		_rest.clear();
+		size_t scan = 0;
+		while( !_eof ) {
+			// cuts at the last newline once the block is large enough.
+			if( buf.size() >= chunkSize ) {
+				auto it = static_cast<char const*>( memrchr( buf.data() + scan, '\n', buf.size() - scan ) );
+				if( it != nullptr ) {
+					size_t n = it - buf.data() + 1;
+					_rest.assign( buf, n, string::npos );
+					buf.resize( n );
+					break;
+				}
+				scan = buf.size();
+			}
+
+			size_t size = buf.size();
+			buf.resize( size + chunkSize );
+			ssize_t n;
+			do {
+				n = read( 0, &buf[size], chunkSize );
+			} while( n < 0 && errno == EINTR );
+			if( n < 0 ) {
+				throw system_error( errno, system_category() );
+			}
+			buf.resize( size + n );
+			_eof = n == 0;
 		}
+		return !buf.empty();
+	}
+
+	private:
+		enum { chunkSize = 1 << 22 };
+
+		string _rest;
+		bool _eof;
+};
 
-		string cmd = argv[optind++];
-		int n = argc - optind;
+// a fixed set of threads which run the tasks in the order of submission.
+template<class Result>
+struct Workers {
+	explicit Workers( size_t n ): _closed( false ) {
+		for( size_t i = 0; i < n; ++i ) {
+			_threads.emplace_back( [this]() -> void {
+				_run();
+			} );
+		}
+	}
 
-		for( auto&& e: commands ) {
-			if( cmd == e.name ) {
-				if( e.arity >= 0 && e.arity != n ) {
-					throw exception();
+	~Workers() {
+		{
+			lock_guard<mutex> lock( _mutex );
+			_closed = true;
+		}
+		_cond.notify_all();
+		for( auto& t: _threads ) {
+			t.join();
+		}
+	}
+
+	template<class Func>
+	future<Result> push( Func&& f ) {
+		packaged_task<Result()> task( forward<Func>( f ) );
+		future<Result> result = task.get_future();
+		{
+			lock_guard<mutex> lock( _mutex );
+			_queue.push_back( move( task ) );
+		}
+		_cond.notify_one();
+		return result;
+	}
+
+	private:
+		void _run() {
+			while( true ) {
+				packaged_task<Result()> task;
+				{
+					unique_lock<mutex> lock( _mutex );
+					_cond.wait( lock, [this]() { return _closed || !_queue.empty(); } );
+					if( _queue.empty() ) {
+						return;
+					}
+					task = move( _queue.front() );
+					_queue.pop_front();
 				}
-				e.func( argv + optind, n );
-				return 0;
+				task();
 			}
 		}
+
+		vector<thread> _threads;
+		deque<packaged_task<Result()>> _queue;
+		mutex _mutex;
+		condition_variable _cond;
+		bool _closed;
+};
+
+// runs the command on the blocks of stdin by n threads.  the results are
+// written in the order of the blocks.  at most n blocks are queued or being
+// processed at a time.
+void runParallel( vector<string> const& args, size_t n, StdOut& out ) {
+	// the lines before an error are written as in the sequential run.
+	struct Result {
+		string dst;
+		exception_ptr error;
+	};
+
+	auto process = [&args]( string const& chunk ) -> Result {
+		MemIn in( chunk.data(), chunk.data() + chunk.size() );
+		MemOut dst;
+		try {
+			str::run( args, in, dst, '\n' );
+		}
+		catch( ... ) {
+			return Result{ move( dst.dst ), current_exception() };
+		}
+		return Result{ move( dst.dst ), nullptr };
+	};
+
+	// checks the arguments even if stdin is empty.
+	MemIn none( nullptr, nullptr );
+	MemOut dst;
+	str::run( args, none, dst, '\n' );
+
+	Chunker chunker;
+	Workers<Result> workers( n );
+	deque<future<Result>> tasks;
+	auto writeFront = [&]() -> void {
+		Result result = tasks.front().get();
+		tasks.pop_front();
+		out.write( result.dst.data(), result.dst.size() );
+		if( result.error ) {
+			rethrow_exception( result.error );
+		}
+	};
+
+	string chunk;
+	while( chunker.next( chunk ) ) {
+		if( tasks.size() >= n ) {
+			writeFront();
+		}
+		tasks.push_back( workers.push( [process, chunk = move( chunk )]() -> Result {
+			return process( chunk );
+		} ) );
+		chunk = string();
+	}
+	while( !tasks.empty() ) {
+		writeFront();
+	}
+}
+
+int main( int argc, char** argv ) {
+	StdOut out;
+	try {
+		// only "-j N" before the command, so that negative indices are taken
+		// as they are.
+		vector<string> args( argv + 1, argv + argc );
+		size_t jobs = 1;
+		if( args.size() >= 2 && args[0] == "-j" ) {
+			jobs = stoul( args[1] );
+			if( jobs == 0 ) {
+				jobs = max( thread::hardware_concurrency(), 1u );
+			}
+			args.erase( args.begin(), args.begin() + 2 );
+		}
+
+		StdIn in;
+		if( jobs > 1 && !(args.size() == 1 && args[0] == "join") ) {
+			runParallel( args, jobs, out );
+		}
+		else if( args.size() == 1 && args[0] == "len" ) {
+			lenLines( in, out );
+		}
+		else if( args.size() == 1 && args[0] == "join" ) {
+			joinLines( in, out );
+		}
+		else {
+			str::run( args, in, out, '\n' );
+		}
+		out.flush();
+		return 0;
 	}
 	catch( exception ) {
 	}
 
+	// the lines before the error are written as they were with cout.
+	try {
+		out.flush();
+	}
+	catch( exception const& ) {
+	}
 	cerr << "error.\n";
 	return -1;
 }
-
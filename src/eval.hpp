@@ -7,19 +7,40 @@ struct Evaluator {
 
 	struct Listener {
 		virtual int  onCommand( ArgIter, ArgIter, int, int, const string& ) = 0;
-		virtual void onBgTask( thread&& ) = 0;
+		virtual void onBgTask( shared_ptr<Scheduler::Task> ) = 0;
 	};
 
+	// values are immutable once stored, so readers take a snapshot without
+	// locking and writers replace the whole value.
 	struct Local {
-		vector<string>& value( ast::Var* );
+		using List = shared_ptr<vector<Value> const>;
+
+		void resize( size_t );
+		List value( ast::Var* ) const;
+		void store( ast::Var*, vector<Value>&& );
 		template<class Iter> bool assign( ast::LeftFix*, Iter, Iter );
 		template<class Iter> bool assign( ast::LeftVar*, Iter, Iter );
 		template<class Iter> bool assign( ast::LeftExpr*, Iter, Iter );
 
 		shared_ptr<Local> outer;
-		vector<vector<string>> vars;
-		vector<vector<string>> defs;
-		string cwd;
+		vector<List> vars;
+		vector<vector<string>> defs; // guarded by mutex.
+		shared_ptr<string const> cwd; // loaded and stored atomically, as vars.
+		std::mutex mutex;
+	};
+
+	// a command which runs in the shell process.  it takes the arguments
+	// without the command name and returns the exit status, or `external' to
+	// run the external command of the same name instead.  a filter takes the
+	// input and the output of the statement as they are, so that it reads and
+	// writes the values of rish pipes without pumping them through fds, and
+	// may run commands in the local of the statement.
+	struct Builtin {
+		static int const external = -256;
+
+		function<int ( vector<string> const&, Evaluator&, int, int, string const& )> func;
+		bool input; // reads the input; otherwise -1 is given as the input.
+		function<int ( vector<string> const&, Evaluator&, Local const&, Input const&, Output const&, char )> filter;
 	};
 
 	struct Closure {
@@ -37,22 +58,49 @@ struct Evaluator {
 		int const retv;
 	};
 
-	Evaluator( Listener* l ): _separator( '\n' ), _listener( l ) {}
+	// if f is true, the stages of pipes and substitutions run as fibers.
+	Evaluator( Listener* l, bool f = false ): _separator( '\n' ), _fibers( f ), _listener( l ) {}
 
-	template<class Iter> int callCommand( Iter, Iter, Local const&, int, int );
+	template<class Iter> int callCommand( Iter, Iter, Local const&, Input const&, Output const& );
 	template<class Iter> Iter evalExpr( ast::Expr*, shared_ptr<Local>, Iter );
 	template<class Iter> Iter evalArgs( ast::Expr*, shared_ptr<Local>, Iter );
-	int evalStmt( ast::Stmt*, shared_ptr<Local>, int, int );
+	int evalStmt( ast::Stmt*, shared_ptr<Local>, Input const&, Output const& );
+	void joinBg( uint64_t );
+
+	map<string, Builtin> builtins; // filled before the evaluation.
 
 	private:
+		bool isExternal( ast::Stmt*, bool );
+		Value evalSingle( ast::Expr*, Local const& );
+
 		char                 _separator; // XXX: better to be function local?
+		bool                 _fibers;
 		Listener*            _listener;
 		map<string, Closure> _closures;
-		mutex                _mutex;
+		shared_timed_mutex   _closuresMutex;
+		map<uint64_t, shared_ptr<Scheduler::Task>> _bgTasks;
+		mutex                _bgTasksMutex;
+		DirCache             _dirs;
 };
 
 
-inline vector<string>& Evaluator::Local::value( ast::Var* var ) {
+inline void Evaluator::Local::resize( size_t n ) {
+	static List const empty = make_shared<vector<Value> const>();
+	vars.resize( n, empty );
+}
+
+inline Evaluator::Local::List Evaluator::Local::value( ast::Var* var ) const {
+	assert( var->depth >= 0 );
+	assert( var->index >= 0 );
+
+	Local const* it = this;
+	for( int i = 0; i < var->depth; ++i ) {
+		it = it->outer.get();
+	}
+	return atomic_load( &it->vars[var->index] );
+}
+
+inline void Evaluator::Local::store( ast::Var* var, vector<Value>&& val ) {
 	assert( var->depth >= 0 );
 	assert( var->index >= 0 );
 
@@ -60,7 +108,7 @@ inline vector<string>& Evaluator::Local::value( ast::Var* var ) {
 	for( int i = 0; i < var->depth; ++i ) {
 		it = it->outer.get();
 	}
-	return it->vars[var->index];
+	atomic_store( &it->vars[var->index], List( make_shared<vector<Value> const>( move( val ) ) ) );
 }
 
 template<class Iter>
@@ -82,7 +130,7 @@ bool Evaluator::Local::assign( ast::LeftFix* lhs, Iter rhsB, Iter rhsE ) {
 	// assign
 	for( size_t i = 0; i < lhs->var.size(); ++i ) {
 		if( auto var = match<Var>( lhs->var[i].get() ) ) {
-			value( var ) = { rhsB[i] };
+			store( var, { rhsB[i] } );
 		}
 	}
 
@@ -120,19 +168,17 @@ bool Evaluator::Local::assign( ast::LeftVar* lhs, Iter rhsB, Iter rhsE ) {
 	// assign varL
 	for( size_t i = 0; i < lhs->varL.size(); ++i ) {
 		if( auto var = match<Var>( lhs->varL[i].get() ) ) {
-			value( var ) = { rhsL[i] };
+			store( var, { rhsL[i] } );
 		}
 	}
 
 	// assign varM
-	auto& val = value( lhs->varM.get() );
-	val.resize( rhsR - rhsM );
-	copy( rhsM, rhsR, val.begin() );
+	store( lhs->varM.get(), vector<Value>( rhsM, rhsR ) );
 
 	// assign varR
 	for( size_t i = 0; i < lhs->varR.size(); ++i ) {
 		if( auto var = match<Var>( lhs->varR[i].get() ) ) {
-			value( var ) = { rhsR[i] };
+			store( var, { rhsR[i] } );
 		}
 	}
 
@@ -180,50 +226,67 @@ tailRec:
 			goto tailRec;
 		}
 		VCASE( Concat, e ) {
-			vector<MetaString> lhs;
-			vector<MetaString> rhs;
+			vector<Value> lhs;
+			vector<Value> rhs;
 			evalExpr( e->lhs.get(), local, back_inserter( lhs ) );
 			evalExpr( e->rhs.get(), local, back_inserter( rhs ) );
 			for( auto const& lv: lhs ) {
 				for( auto const& rv: rhs ) {
-					*dst++ = lv + rv;
+					*dst++ = lv.text() + rv.text();
 				}
 			}
 		}
 		VCASE( Var, e ) {
-			lock_guard<mutex> lock( _mutex );
-			auto& val = local->value( e );
-			dst = copy( val.cbegin(), val.cend(), dst );
+			auto val = local->value( e );
+			dst = copy( val->cbegin(), val->cend(), dst );
 		}
 		VCASE( Subst, e ) {
+			// the output of a substitution is read in bulk; a larger pipe lets
+			// the writer run longer between the reads.
+			size_t const block = 1 << 20;
+			shared_ptr<Channel> chan;
 			int fds[2];
-			checkSysCall( pipe( fds ) );
+			if( isExternal( e->body.get(), false ) ) {
+				checkSysCall( pipe( fds ) );
+#if defined( F_SETPIPE_SZ )
+				fcntl( fds[0], F_SETPIPE_SZ, int( block ) );
+#endif
+			}
+			else {
+				chan = make_shared<Channel>();
+			}
+			Input  rhsIn  = chan ? Input( chan )  : Input( fds[0], block );
+			Output lhsOut = chan ? Output( chan ) : Output( fds[1] );
 
 			auto reader = [&]() -> void {
-				auto closer = scopeExit( bind( close, fds[0] ) );
-				UnixIStream<> ifs( fds[0] );
+				auto closer = scopeExit( bind( &Input::close, &rhsIn ) );
 				string buf;
-				while( getline( ifs, buf, _separator ) ) {
-					*dst++ = buf;
+				while( rhsIn.get( buf, _separator ) ) {
+					*dst++ = move( buf );
 				}
 			};
 			auto writer = [&]() -> void {
 				try {
-					auto ocloser = scopeExit( bind( close, fds[1] ) );
+					auto ocloser = scopeExit( bind( &Output::close, &lhsOut ) );
 					int ifd = checkSysCall( open( "/dev/null", O_RDONLY ) );
 					auto icloser = scopeExit( bind( close, ifd ) );
 
-					evalStmt( e->body.get(), local, ifd, fds[1] );
+					evalStmt( e->body.get(), local, Input( ifd ), lhsOut );
 				}
 				catch( BreakException const& ) {
 				}
 				catch( ReturnException const& ) {
 				}
 			};
-			parallel( writer, reader );
+			if( _fibers ) {
+				fiberParallel( writer, reader );
+			}
+			else {
+				parallel( writer, reader );
+			}
 		}
 		VCASE( BinOp, e ) {
-			vector<MetaString> lhss, rhss;
+			vector<Value> lhss, rhss;
 			evalExpr( e->lhs.get(), local, back_inserter( lhss ) );
 			evalExpr( e->rhs.get(), local, back_inserter( rhss ) );
 			if( (lhss.size() != 0 && rhss.size() == 0) ||
@@ -234,75 +297,38 @@ tailRec:
 			for( size_t i = 0; i < lhss.size() || i < rhss.size(); ++i ) {
 				auto const& lhs = lhss[i % lhss.size()];
 				auto const& rhs = rhss[i % rhss.size()];
-				int64_t lval = stoll( string( lhs ) );
-				int64_t rval = stoll( string( rhs ) );
-				int64_t r;
-				switch( e->op ) {
-					case BinOp::add: r = lval + rval; break;
-					case BinOp::sub: r = lval - rval; break;
-					case BinOp::mul: r = lval * rval; break;
-					case BinOp::div:
-						if( rval == 0 ) {
-							throw invalid_argument( "" );
-						}
-						r = idiv( lval, rval );
-						break;
-					case BinOp::mod:
-						if( rval == 0 ) {
-							throw invalid_argument( "" );
-						}
-						r = imod( lval, rval );
-						break;
-					case BinOp::eq: r = (lval == rval) ? 0 : -1; break;
-					case BinOp::ne: r = (lval != rval) ? 0 : -1; break;
-					case BinOp::le: r = (lval <= rval) ? 0 : -1; break;
-					case BinOp::ge: r = (lval >= rval) ? 0 : -1; break;
-					case BinOp::lt: r = (lval <  rval) ? 0 : -1; break;
-					case BinOp::gt: r = (lval >  rval) ? 0 : -1; break;
-					default:
-						assert( false );
-				}
-				*dst++ = to_string( r );
+				*dst++ = Value( apply( e->op, lhs.toInt(), rhs.toInt() ) );
 			}
 		}
 		VCASE( UniOp, e ) {
-			vector<MetaString> lhs;
+			vector<Value> lhs;
 			evalExpr( e->lhs.get(), local, back_inserter( lhs ) );
 			for( auto const& v: lhs ) {
-				int64_t val = stoll( string( v ) );
-				int64_t r;
-				switch( e->op ) {
-					case UniOp::pos: r = +val; break;
-					case UniOp::neg: r = -val; break;
-					default:
-						assert( false );
-				}
-				*dst++ = to_string( r );
+				*dst++ = Value( apply( e->op, v.toInt() ) );
 			}
 		}
 		VCASE( Size, e ) {
-			lock_guard<mutex> lock( _mutex );
-			auto& val = local->value( e->var.get() );
-			*dst++ = to_string( val.size() );
+			auto val = local->value( e->var.get() );
+			*dst++ = Value( int64_t( val->size() ) );
 		}
 		VCASE( Index, e ) {
-			vector<MetaString> sIdcs;
+			vector<Value> sIdcs;
 			evalExpr( e->idx.get(), local, back_inserter( sIdcs ) );
 
-			lock_guard<mutex> lock( _mutex );
-			auto& val = local->value( e->var.get() );
+			auto snapshot = local->value( e->var.get() );
+			auto const& val = *snapshot;
 			if( val.size() == 0 && sIdcs.size() != 0 ) {
 				throw invalid_argument( "" );
 			}
 			for( auto const& sIdx: sIdcs ) {
-				int64_t idx = stoll( string( sIdx ) );
+				int64_t idx = sIdx.toInt();
 				idx = imod( idx, val.size() );
 				*dst++ = val[idx];
 			}
 		}
 		VCASE( Slice, e ) {
-			vector<MetaString> sBgns;
-			vector<MetaString> sEnds;
+			vector<Value> sBgns;
+			vector<Value> sEnds;
 			evalExpr( e->bgn.get(), local, back_inserter( sBgns ) );
 			evalExpr( e->end.get(), local, back_inserter( sEnds ) );
 			if( (sBgns.size() != 0 && sEnds.size() == 0) ||
@@ -310,8 +336,8 @@ tailRec:
 				throw invalid_argument( "" );
 			}
 
-			lock_guard<mutex> lock( _mutex );
-			auto& val = local->value( e->var.get() );
+			auto snapshot = local->value( e->var.get() );
+			auto const& val = *snapshot;
 			if( val.size() == 0 && (sBgns.size() != 0 || sEnds.size() != 0) ) {
 				throw invalid_argument( "" );
 			}
@@ -319,8 +345,8 @@ tailRec:
 			for( size_t i = 0; i < sBgns.size() || i < sEnds.size(); ++i ) {
 				auto const& sBgn = sBgns[i % sBgns.size()];
 				auto const& sEnd = sEnds[i % sEnds.size()];
-				int64_t bgn = stoll( string( sBgn ) );
-				int64_t end = stoll( string( sEnd ) );
+				int64_t bgn = sBgn.toInt();
+				int64_t end = sEnd.toInt();
 				bgn = imod( bgn, val.size() );
 				end = imod( end, val.size() );
 				if( bgn < end ) {
@@ -341,8 +367,53 @@ tailRec:
 	return dst;
 }
 
+// evaluates an expression which is statically one value (see Annotator).
+inline Value Evaluator::evalSingle( ast::Expr* expr, Local const& local ) {
+	using namespace ast;
+
+	VSWITCH( expr ) {
+		VCASE( Word, e ) {
+			return e->word;
+		}
+		VCASE( Home, e ) {
+			// XXX
+			return string( getenv( "HOME" ) );
+		}
+		VCASE( Pair, e ) {
+			bool lhs = Annotator::count( e->lhs.get(), false ) != 0;
+			return evalSingle( lhs ? e->lhs.get() : e->rhs.get(), local );
+		}
+		VCASE( Concat, e ) {
+			return evalSingle( e->lhs.get(), local ).text() + evalSingle( e->rhs.get(), local ).text();
+		}
+		VCASE( BinOp, e ) {
+			int64_t lhs = evalSingle( e->lhs.get(), local ).toInt();
+			int64_t rhs = evalSingle( e->rhs.get(), local ).toInt();
+			return Value( apply( e->op, lhs, rhs ) );
+		}
+		VCASE( UniOp, e ) {
+			return Value( apply( e->op, evalSingle( e->lhs.get(), local ).toInt() ) );
+		}
+		VCASE( Size, e ) {
+			return Value( int64_t( local.value( e->var.get() )->size() ) );
+		}
+		VCASE( Index, e ) {
+			auto val = local.value( e->var.get() );
+			if( val->size() == 0 ) {
+				throw invalid_argument( "" );
+			}
+			int64_t idx = evalSingle( e->idx.get(), local ).toInt();
+			return (*val)[imod( idx, val->size() )];
+		}
+		VDEFAULT {
+			assert( false );
+		}
+	}
+	return Value( 0 );
+}
+
 template<class Iter>
-int Evaluator::callCommand( Iter argsB, Iter argsE, Local const& local, int ifd, int ofd ) {
+int Evaluator::callCommand( Iter argsB, Iter argsE, Local const& local, Input const& in, Output const& out ) {
 	assert( argsE - argsB >= 1 );
 
 	if( argsE - argsB == 1 ) {
@@ -353,23 +424,28 @@ int Evaluator::callCommand( Iter argsB, Iter argsE, Local const& local, int ifd,
 		}
 	}
 
-	_mutex.lock();
-	auto fit = _closures.find( argsB[0] );
-	if( fit != _closures.end() ) {
-		Closure cl = fit->second;
-		_mutex.unlock();
-
+	Closure cl;
+	bool found;
+	{
+		shared_lock<shared_timed_mutex> lock( _closuresMutex );
+		auto fit = _closures.find( argsB[0] );
+		found = fit != _closures.end();
+		if( found ) {
+			cl = fit->second;
+		}
+	}
+	if( found ) {
 		auto child = make_shared<Local>();
-		child->vars.resize( cl.nVar );
+		child->resize( cl.nVar );
 		if( !child->assign( cl.args.get(), argsB + 1, argsE ) ) {
 			throw invalid_argument( "" ); // or allow overloaded functions?
 		}
 		child->outer = move( cl.env );
-		child->cwd = local.cwd;
+		child->cwd = atomic_load( &local.cwd );
 
 		int retv;
 		try {
-			retv = evalStmt( cl.body.get(), child, ifd, ofd );
+			retv = evalStmt( cl.body.get(), child, in, out );
 		}
 		catch( ReturnException const& e ) {
 			retv = e.retv;
@@ -379,7 +455,7 @@ int Evaluator::callCommand( Iter argsB, Iter argsE, Local const& local, int ifd,
 			callCommand(
 				make_move_iterator( it->begin() ),
 				make_move_iterator( it->end() ),
-				*child, ifd, ofd
+				*child, in, out
 			);
 		}
 		// child.defs is not required anymore but local itself may be
@@ -388,21 +464,53 @@ int Evaluator::callCommand( Iter argsB, Iter argsE, Local const& local, int ifd,
 
 		return retv;
 	}
+
+	// chdir in a parallel stage does not change it during the command.
+	auto cwd = atomic_load( &local.cwd );
+	auto bit = builtins.find( argsB[0] );
+	if( bit == builtins.end() ) {
+		InputFd  ifd( in, _separator );
+		OutputFd ofd( out, _separator );
+		return _listener->onCommand( argsB, argsE, ifd.get(), ofd.get(), *cwd );
+	}
+
+	vector<string> args( argsB + 1, argsE );
+	int retv;
+	if( bit->second.filter ) {
+		retv = bit->second.filter( args, *this, local, in, out, _separator );
+	}
+	else if( bit->second.input ) {
+		InputFd  ifd( in, _separator );
+		OutputFd ofd( out, _separator );
+		retv = bit->second.func( args, *this, ifd.get(), ofd.get(), *cwd );
+	}
 	else {
-		_mutex.unlock();
+		OutputFd ofd( out, _separator );
+		retv = bit->second.func( args, *this, -1, ofd.get(), *cwd );
+	}
+	if( retv != Builtin::external ) {
+		return retv;
 	}
 
-	return _listener->onCommand( argsB, argsE, ifd, ofd, local.cwd );
+	args.insert( args.begin(), argsB[0] );
+	InputFd  ifd( in, _separator );
+	OutputFd ofd( out, _separator );
+	return _listener->onCommand(
+		make_move_iterator( args.begin() ),
+		make_move_iterator( args.end() ),
+		ifd.get(), ofd.get(), *cwd
+	);
 }
 
 template<class DstIter>
 DstIter Evaluator::evalArgs( ast::Expr* expr, shared_ptr<Local> local, DstIter dstIt ) {
 	struct Inserter: std::iterator<output_iterator_tag, Inserter> {
 		string const* cwd;
+		DirCache* dirs;
 		DstIter dstIt;
 
-		explicit Inserter( string const* c, DstIter it ):
-			cwd( c ), dstIt( it ) {
+		explicit Inserter( string const* c, DirCache* d, DstIter it ):
+			cwd( c ), dirs( d ), dstIt( it ) {
 		}
 		Inserter& operator*() {
 			return *this;
@@ -413,21 +521,70 @@ DstIter Evaluator::evalArgs( ast::Expr* expr, shared_ptr<Local> local, DstIter d
 		Inserter& operator++( int ) {
 			return *this;
 		}
-		Inserter operator=( MetaString&& str ) {
-			this->dstIt = expandGlob( move( str ), *this->cwd, this->dstIt );
-			return *this;
-		}
-		Inserter operator=( MetaString const& str ) {
-			this->dstIt = expandGlob( str, *this->cwd, this->dstIt );
+		Inserter operator=( Value const& val ) {
+			this->dstIt = expandGlob( val, *this->cwd, *this->dirs, this->dstIt );
 			return *this;
 		}
 	};
-	Inserter inserter( &local->cwd, dstIt );
+	// words without globs are passed through.
+	if( auto pair = match<ast::Pair>( expr ) ) {
+		dstIt = evalArgs( pair->lhs.get(), local, dstIt );
+		return evalArgs( pair->rhs.get(), local, dstIt );
+	}
+	if( auto word = match<ast::Word>( expr ) ) {
+		if( !word->glob ) {
+			*dstIt++ = string( word->word );
+			return dstIt;
+		}
+	}
+
+	auto cwd = atomic_load( &local->cwd );
+	Inserter inserter( cwd.get(), &_dirs, dstIt );
 	evalExpr( expr, local, inserter );
 	return inserter.dstIt;
 }
 
-inline int Evaluator::evalStmt( ast::Stmt* stmt, shared_ptr<Local> local, int ifd, int ofd ) {
+// a rough guess whether the end of the stage which faces to a pipe is an
+// external process.  it only chooses the kind of the pipe; both kinds carry the
+// same records, so a wrong guess costs extra copies, not correctness.
+inline bool Evaluator::isExternal( ast::Stmt* stmt, bool reader ) {
+	using namespace ast;
+
+	VSWITCH( stmt ) {
+		VCASE( Pipe, s ) {
+			return isExternal( reader ? s->lhs.get() : s->rhs.get(), reader );
+		}
+		VCASE( RedirFr, s ) {
+			return !reader && isExternal( s->body.get(), reader );
+		}
+		VCASE( RedirTo, s ) {
+			return reader && isExternal( s->body.get(), reader );
+		}
+		VCASE( Command, s ) {
+			auto pair = match<Pair>( s->args.get() );
+			auto word = pair ? match<Word>( pair->lhs.get() ) : nullptr;
+			if( word == nullptr || word->glob ) {
+				return false;
+			}
+
+			string name( word->word );
+			auto bit = builtins.find( name );
+			if( bit != builtins.end() && bit->second.filter ) {
+				return false;
+			}
+			shared_lock<shared_timed_mutex> lock( _closuresMutex );
+			return _closures.find( name ) == _closures.end();
+		}
+		VDEFAULT {
+			return false;
+		}
+	}
+
+	assert( false );
+	return false;
+}
+
+inline int Evaluator::evalStmt( ast::Stmt* stmt, shared_ptr<Local> local, Input const& in, Output const& out ) {
 	using namespace ast;
 
 tailRec:
@@ -435,9 +592,9 @@ tailRec:
 
 	try { VSWITCH( stmt ) {
 		VCASE( Sequence, s ) {
-			evalStmt( s->lhs.get(), local, ifd, ofd );
+			evalStmt( s->lhs.get(), local, in, out );
 
-			// return evalStmt( s->rhs.get(), local, ifd, ofd );
+			// return evalStmt( s->rhs.get(), local, in, out );
 			stmt = s->rhs.get();
 			goto tailRec;
 		}
@@ -448,7 +605,7 @@ tailRec:
 			int rval = 0;
 			auto evalLhs = [&]() -> void {
 				try {
-					lval = evalStmt( s->lhs.get(), local, ifd, ofd );
+					lval = evalStmt( s->lhs.get(), local, in, out );
 				}
 				catch( BreakException const& e ) {
 					lval = e.retv;
@@ -460,13 +617,13 @@ tailRec:
 			};
 			auto evalRhs = [&]() -> void {
 				try {
-					rval = evalStmt( s->rhs.get(), local, ifd, ofd );
+					rval = evalStmt( s->rhs.get(), local, in, out );
 				}
 				catch( BreakException const& e ) {
 					rval = e.retv;
 				}
 				catch( ReturnException const& e ) {
-					lret = true;
+					rret = true;
 					rval = e.retv;
 				}
 			};
@@ -482,22 +639,25 @@ tailRec:
 		VCASE( Bg, s ) {
 			// keep the reference to AST
 			shared_ptr<Stmt> body = s->body;
-			thread thr( [=]() -> void {
+			auto task = Scheduler::instance().spawn( [=]() -> void {
+				// a background job may run forever; it leaves its slot to the
+				// foreground ones, as a blocked worker does.
+				Scheduler::Blocking blocking;
+
 				int ifd = checkSysCall( open( "/dev/null", O_RDONLY ) );
 				auto icloser = scopeExit( bind( close, ifd ) );
 				int ofd = checkSysCall( open( "/dev/null", O_WRONLY ) );
 				auto ocloser = scopeExit( bind( close, ofd ) );
 
-				this->evalStmt( body.get(), local, ifd, ofd );
+				this->evalStmt( body.get(), local, Input( ifd ), ofd );
 			} );
-			thread::id id = thr.get_id();
-
-			_listener->onBgTask( move( thr ) );
+			_listener->onBgTask( task );
+			{
+				lock_guard<mutex> lock( _bgTasksMutex );
+				_bgTasks[task->id] = task;
+			}
 
-			ostringstream ofs;
-			ofs.exceptions( ios_base::failbit | ios_base::badbit );
-			ofs << id << _separator;
-			writeAll( ofd, ofs.str() );
+			out.put( to_string( task->id ), _separator );
 			return 0;
 		}
 		VCASE( RedirFr, s ) {
@@ -510,7 +670,7 @@ tailRec:
 			int fd = open( args[0].c_str(), O_RDONLY );
 			checkSysCall( fd );
 			auto closer = scopeExit( bind( close, fd ) );
-			return evalStmt( s->body.get(), local, fd, ofd );
+			return evalStmt( s->body.get(), local, Input( fd ), out );
 		}
 		VCASE( RedirTo, s ) {
 			vector<string> args;
@@ -522,11 +682,21 @@ tailRec:
 			int fd = open( args[0].c_str(), O_WRONLY | O_CREAT, 0644 );
 			checkSysCall( fd );
 			auto closer = scopeExit( bind( close, fd ) );
-			return evalStmt( s->body.get(), local, ifd, fd );
+			return evalStmt( s->body.get(), local, in, fd );
 		}
 		VCASE( Command, s ) {
 			vector<string> args;
-			evalArgs( s->args.get(), local, back_inserter( args ) );
+			if( s->single ) {
+				Value val = evalSingle( s->args.get(), *local );
+				// same as callCommand() with an integer.
+				if( val.isInt() ) {
+					return val.toInt();
+				}
+				args.push_back( val.str() );
+			}
+			else {
+				evalArgs( s->args.get(), local, back_inserter( args ) );
+			}
 			if( args.size() == 0 ) {
 				return 0;
 			}
@@ -534,7 +704,7 @@ tailRec:
 			return callCommand(
 				make_move_iterator( args.begin() ),
 				make_move_iterator( args.end() ),
-				*local, ifd, ofd
+				*local, in, out
 			);
 		}
 		VCASE( Return, s ) {
@@ -556,7 +726,7 @@ tailRec:
 				throw invalid_argument( "" );
 			}
 
-			lock_guard<mutex> lock( _mutex );
+			lock_guard<shared_timed_mutex> lock( _closuresMutex );
 			_closures[args[0]] = { s->nVar, s->args, s->body, local };
 			return 0;
 		}
@@ -567,32 +737,32 @@ tailRec:
 				throw invalid_argument( "" );
 			}
 
-			lock_guard<mutex> lock( _mutex );
+			lock_guard<shared_timed_mutex> lock( _closuresMutex );
 			return _closures.erase( args[0] ) != 0 ? 0 : 1;
 		}
 		VCASE( If, s ) {
-			if( evalStmt( s->cond.get(), local, ifd, ofd ) == 0 ) {
-				// return evalStmt( s->then.get(), local, ifd, ofd );
+			if( evalStmt( s->cond.get(), local, in, out ) == 0 ) {
+				// return evalStmt( s->then.get(), local, in, out );
 				stmt = s->then.get();
 				goto tailRec;
 			}
 			else {
-				// return evalStmt( s->elze.get(), local, ifd, ofd );
+				// return evalStmt( s->elze.get(), local, in, out );
 				stmt = s->elze.get();
 				goto tailRec;
 			}
 		}
 		VCASE( While, s ) {
-			while( evalStmt( s->cond.get(), local, ifd, ofd ) == 0 ) {
+			while( evalStmt( s->cond.get(), local, in, out ) == 0 ) {
 				try {
-					evalStmt( s->body.get(), local, ifd, ofd );
+					evalStmt( s->body.get(), local, in, out );
 				}
 				catch( BreakException const& e ) {
 					return e.retv;
 				}
 			}
 
-			// return evalStmt( s->elze.get(), local, ifd, ofd );
+			// return evalStmt( s->elze.get(), local, in, out );
 			stmt = s->elze.get();
 			goto tailRec;
 		}
@@ -609,10 +779,14 @@ tailRec:
 			}
 		}
 		VCASE( Let, s ) {
+			if( s->single ) {
+				Value val = evalSingle( s->rhs.get(), *local );
+				return local->assign( s->lhs.get(), make_move_iterator( &val ), make_move_iterator( &val + 1 ) ) ? 0 : 1;
+			}
+
 			vector<string> vals;
 			evalArgs( s->rhs.get(), local, back_inserter( vals ) );
 
-			lock_guard<mutex> lock( _mutex );
 			return local->assign(
 				s->lhs.get(),
 				make_move_iterator( vals.begin() ),
@@ -622,15 +796,13 @@ tailRec:
 		VCASE( Fetch, s ) {
 			VSWITCH( s->lhs.get() ) {
 				VCASE( LeftFix, lhs ) {
-					UnixIStream<1> ifs( ifd );
 					vector<string> rhs( lhs->var.size() );
 					for( auto& v: rhs ) {
-						if( !getline( ifs, v, _separator ) ) {
+						if( !in.get( v, _separator ) ) {
 							return 1;
 						}
 					}
 
-					lock_guard<mutex> lock( _mutex );
 					return local->assign(
 						lhs,
 						make_move_iterator( rhs.begin() ),
@@ -639,13 +811,11 @@ tailRec:
 				}
 				VCASE( LeftVar, lhs ) {
 					vector<string> rhs;
-					UnixIStream<> ifs( ifd );
 					string buf;
-					while( getline( ifs, buf, _separator ) ) {
-						rhs.push_back( buf );
+					while( in.get( buf, _separator ) ) {
+						rhs.push_back( move( buf ) );
 					}
 
-					lock_guard<mutex> lock( _mutex );
 					return local->assign(
 						lhs,
 						make_move_iterator( rhs.begin() ),
@@ -658,18 +828,28 @@ tailRec:
 			}
 		}
 		VCASE( Yield, s ) {
+			if( s->single ) {
+				out.put( evalSingle( s->rhs.get(), *local ).str(), _separator );
+				return 0;
+			}
+
 			vector<string> vals;
 			evalArgs( s->rhs.get(), local, back_inserter( vals ) );
-			ostringstream buf;
-			for( auto const& v: vals ) {
-				buf << v << _separator;
-			}
-			writeAll( ofd, buf.str() );
+			out.put( make_move_iterator( vals.begin() ), make_move_iterator( vals.end() ), _separator );
 			return 0;
 		}
 		VCASE( Pipe, s ) {
+			// rish-to-rish pipes pass values through an in-process channel.
+			shared_ptr<Channel> chan;
 			int fds[2];
-			checkSysCall( pipe( fds ) );
+			if( isExternal( s->lhs.get(), false ) || isExternal( s->rhs.get(), true ) ) {
+				checkSysCall( pipe( fds ) );
+			}
+			else {
+				chan = make_shared<Channel>();
+			}
+			Input  rhsIn  = chan ? Input( chan )  : Input( fds[0] );
+			Output lhsOut = chan ? Output( chan ) : Output( fds[1] );
 
 			bool lret = false;
 			bool rret = false;
@@ -677,8 +857,8 @@ tailRec:
 			int rval = 0;
 			auto evalLhs = [&]() -> void {
 				try {
-					auto closer = scopeExit( bind( close, fds[1] ) );
-					lval = evalStmt( s->lhs.get(), local, ifd, fds[1] );
+					auto closer = scopeExit( bind( &Output::close, &lhsOut ) );
+					lval = evalStmt( s->lhs.get(), local, in, lhsOut );
 				}
 				catch( BreakException const& e ) {
 					lval = e.retv;
@@ -690,8 +870,8 @@ tailRec:
 			};
 			auto evalRhs = [&]() -> void {
 				try {
-					auto closer = scopeExit( bind( close, fds[0] ) );
-					rval = evalStmt( s->rhs.get(), local, fds[0], ofd );
+					auto closer = scopeExit( bind( &Input::close, &rhsIn ) );
+					rval = evalStmt( s->rhs.get(), local, rhsIn, out );
 				}
 				catch( BreakException const& e ) {
 					rval = e.retv;
@@ -701,7 +881,12 @@ tailRec:
 					rval = e.retv;
 				}
 			};
-			parallel( evalLhs, evalRhs );
+			if( _fibers ) {
+				fiberParallel( evalLhs, evalRhs );
+			}
+			else {
+				parallel( evalLhs, evalRhs );
+			}
 			if( lret ) {
 				throw ReturnException{ lval };
 			}
@@ -726,21 +911,21 @@ tailRec:
 				return 1;
 			}
 
-			ostringstream buf;
+			vector<string> buf;
+			buf.reserve( vals.size() * vals[0].size() );
 			for( size_t j = 0; j < vals[0].size(); ++j ) {
 				for( size_t i = 0; i < vals.size(); ++i ) {
-					buf << vals[i][j] << _separator;
+					buf.push_back( move( vals[i][j] ) );
 				}
 			}
-			writeAll( ofd, buf.str() );
-
+			out.put( make_move_iterator( buf.begin() ), make_move_iterator( buf.end() ), _separator );
 			return 0;
 		}
 		VCASE( Defer, s ) {
 			vector<string> args;
 			evalArgs( s->args.get(), local, back_inserter( args ) );
 
-			lock_guard<mutex> lock( _mutex );
+			lock_guard<mutex> lock( local->mutex );
 			local->defs.push_back( move( args ) );
 			return 0;
 		}
@@ -751,8 +936,7 @@ tailRec:
 				throw invalid_argument( "" );
 			}
 
-			lock_guard<mutex> lock( _mutex );
-			local->cwd = args[0];
+			atomic_store( &local->cwd, make_shared<string const>( args[0] ) );
 			return 0;
 		}
 		VCASE( None, s ) {
@@ -772,3 +956,18 @@ tailRec:
 	assert( false );
 	return -1;
 }
+
+// waits for the background task of the id if it has not been joined yet.
+inline void Evaluator::joinBg( uint64_t id ) {
+	shared_ptr<Scheduler::Task> task;
+	{
+		lock_guard<mutex> lock( _bgTasksMutex );
+		auto it = _bgTasks.find( id );
+		if( it == _bgTasks.end() ) {
+			return;
+		}
+		task = move( it->second );
+		_bgTasks.erase( it );
+	}
+	task->join();
+}
@@ -0,0 +1,298 @@
+// (c) Yasuhiro Fujii <y-fujii at mimosa-pudica.net> / 2-clause BSD license
+#pragma once
+
+
+// stackful coroutines multiplexed on one OS thread.  a fiber which waits for a
+// channel, another fiber or a file descriptor is parked and the others run
+// instead; the thread blocks only when all of them are waiting.
+struct FiberLoop {
+	struct Fiber {
+		Fiber( Fiber const& ) = delete;
+		Fiber& operator=( Fiber const& ) = delete;
+
+		explicit Fiber( function<void ()>&& f ):
+			func( move( f ) ), done( false ), parked( false ), wakeup( false ) {
+			stack = mmap(
+				nullptr, stackSize, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0
+			);
+			if( stack == MAP_FAILED ) {
+				throw system_error( errno, system_category() );
+			}
+			// guard page.
+			mprotect( stack, getpagesize(), PROT_NONE );
+		}
+
+		~Fiber() {
+			munmap( stack, stackSize );
+		}
+
+		static size_t const stackSize = 8 << 20;
+
+		ucontext_t context;
+		void* stack;
+		function<void ()> func;
+		bool done;
+		bool parked;
+		bool wakeup;
+		shared_ptr<Fiber> joiner;
+	};
+
+	FiberLoop( FiberLoop const& ) = delete;
+	FiberLoop& operator=( FiberLoop const& ) = delete;
+
+	FiberLoop(): _nLive( 0 ) {
+		assert( current() == nullptr );
+		if( pipe( _wakeFds ) < 0 ) {
+			throw system_error( errno, system_category() );
+		}
+		fcntl( _wakeFds[0], F_SETFL, O_NONBLOCK );
+		fcntl( _wakeFds[1], F_SETFL, O_NONBLOCK );
+		current() = this;
+	}
+
+	~FiberLoop() {
+		current() = nullptr;
+		close( _wakeFds[0] );
+		close( _wakeFds[1] );
+	}
+
+	// the loop of the current thread, or nullptr.
+	static FiberLoop*& current() {
+		static __thread FiberLoop* loop = nullptr;
+		return loop;
+	}
+
+	// the running fiber of the current thread, or nullptr.
+	static shared_ptr<Fiber> running() {
+		FiberLoop* loop = current();
+		return loop != nullptr ? loop->_running : nullptr;
+	}
+
+	shared_ptr<Fiber> spawn( function<void ()> func ) {
+		auto fiber = make_shared<Fiber>( move( func ) );
+		if( getcontext( &fiber->context ) < 0 ) {
+			throw system_error( errno, system_category() );
+		}
+		fiber->context.uc_stack.ss_sp = fiber->stack;
+		fiber->context.uc_stack.ss_size = Fiber::stackSize;
+		fiber->context.uc_link = &_sched;
+		makecontext( &fiber->context, &FiberLoop::_entry, 0 );
+
+		++_nLive;
+		lock_guard<mutex> lock( _mutex );
+		_ready.push_back( fiber );
+		return fiber;
+	}
+
+	// runs the fibers until all of them finish.  Guard is constructed around
+	// the waits of the thread.
+	template<class Guard>
+	void run();
+
+	// suspends the running fiber until resume() is called.  it may return
+	// spuriously, so the callers must check their conditions again.
+	void park() {
+		Fiber* fiber = _running.get();
+		assert( fiber != nullptr );
+		{
+			lock_guard<mutex> lock( _mutex );
+			if( fiber->wakeup ) {
+				fiber->wakeup = false;
+				return;
+			}
+			fiber->parked = true;
+		}
+		swapcontext( &fiber->context, &_sched );
+	}
+
+	// makes the fiber runnable.  this can be called from any thread.
+	void resume( shared_ptr<Fiber> const& fiber ) {
+		lock_guard<mutex> lock( _mutex );
+		if( fiber->parked ) {
+			fiber->parked = false;
+			_ready.push_back( fiber );
+			uint8_t dummy = 0;
+			if( write( _wakeFds[1], &dummy, 1 ) < 0 && errno != EAGAIN ) {
+				terminate();
+			}
+		}
+		else {
+			fiber->wakeup = true;
+		}
+	}
+
+	// lets the others run.
+	void yield() {
+		Fiber* fiber = _running.get();
+		{
+			lock_guard<mutex> lock( _mutex );
+			_ready.push_back( _running );
+		}
+		swapcontext( &fiber->context, &_sched );
+	}
+
+	void join( shared_ptr<Fiber> const& fiber ) {
+		while( !fiber->done ) {
+			fiber->joiner = _running;
+			park();
+		}
+	}
+
+	// parks the running fiber until the file descriptor may become ready or
+	// the thread is interrupted.
+	void waitFd( int fd, short events ) {
+		_waiting.emplace_back( _running, pollfd{ fd, events, 0 } );
+		park();
+
+		// remove the entry if it is a spurious wakeup.
+		auto it = find_if( _waiting.begin(), _waiting.end(), [&]( tuple<shared_ptr<Fiber>, pollfd> const& w ) {
+			return get<0>( w ) == _running;
+		} );
+		if( it != _waiting.end() ) {
+			_waiting.erase( it );
+		}
+	}
+
+	private:
+		static void _entry() {
+			FiberLoop* self = current();
+			Fiber* fiber = self->_running.get();
+			fiber->func();
+			fiber->func = nullptr;
+			fiber->done = true;
+			if( fiber->joiner ) {
+				self->resume( fiber->joiner );
+				fiber->joiner = nullptr;
+			}
+			// returns to uc_link.
+		}
+
+		int                                     _nLive;
+		int                                     _wakeFds[2];
+		ucontext_t                              _sched;
+		shared_ptr<Fiber>                       _running;
+		deque<shared_ptr<Fiber>>                _ready;
+		vector<tuple<shared_ptr<Fiber>, pollfd>> _waiting;
+		mutex                                   _mutex;
+};
+
+template<class Guard>
+void FiberLoop::run() {
+	while( _nLive > 0 ) {
+		shared_ptr<Fiber> fiber;
+		{
+			lock_guard<mutex> lock( _mutex );
+			if( !_ready.empty() ) {
+				fiber = move( _ready.front() );
+				_ready.pop_front();
+			}
+		}
+
+		if( fiber ) {
+			_running = fiber;
+			swapcontext( &_sched, &fiber->context );
+			_running = nullptr;
+			if( fiber->done ) {
+				--_nLive;
+			}
+			continue;
+		}
+
+		// all the fibers are waiting for something.
+		vector<pollfd> pfds;
+		pfds.push_back( pollfd{ _wakeFds[0], POLLIN, 0 } );
+		for( auto const& w: _waiting ) {
+			pfds.push_back( get<1>( w ) );
+		}
+		int n;
+		{
+			Guard guard;
+			n = poll( pfds.data(), pfds.size(), -1 );
+		}
+		if( n < 0 && errno != EINTR ) {
+			throw system_error( errno, system_category() );
+		}
+
+		uint8_t buf[PIPE_BUF];
+		while( read( _wakeFds[0], buf, sizeof( buf ) ) > 0 ) {
+		}
+
+		// on interruption, wake all the waiters up so that they can check it.
+		vector<tuple<shared_ptr<Fiber>, pollfd>> waiting;
+		for( size_t i = 0; i < _waiting.size(); ++i ) {
+			if( n < 0 || pfds[i + 1].revents != 0 ) {
+				resume( get<0>( _waiting[i] ) );
+			}
+			else {
+				waiting.push_back( move( _waiting[i] ) );
+			}
+		}
+		swap( waiting, _waiting );
+	}
+}
+
+// a condition variable which parks the running fiber instead of blocking the
+// thread, if any.
+struct CondVar {
+	template<class Pred>
+	void wait( unique_lock<mutex>& lock, Pred pred ) {
+		FiberLoop* loop = FiberLoop::current();
+		shared_ptr<FiberLoop::Fiber> fiber = FiberLoop::running();
+		if( !fiber ) {
+			_cond.wait( lock, pred );
+			return;
+		}
+
+		while( !pred() ) {
+			_fibers.emplace_back( loop, fiber );
+			lock.unlock();
+			loop->park();
+			lock.lock();
+		}
+	}
+
+	// must be called with the lock held.
+	void notify_one() {
+		_cond.notify_one();
+		_resumeFibers();
+	}
+
+	// must be called with the lock held.
+	void notify_all() {
+		_cond.notify_all();
+		_resumeFibers();
+	}
+
+	private:
+		void _resumeFibers() {
+			for( auto const& f: _fibers ) {
+				get<0>( f )->resume( get<1>( f ) );
+			}
+			_fibers.clear();
+		}
+
+		condition_variable _cond;
+		vector<tuple<FiberLoop*, shared_ptr<FiberLoop::Fiber>>> _fibers;
+};
+
+// one-shot event which can be waited for by both threads and fibers.
+struct Latch {
+	Latch(): _done( false ) {}
+
+	void set() {
+		lock_guard<mutex> lock( _mutex );
+		_done = true;
+		_cond.notify_all();
+	}
+
+	void wait() {
+		unique_lock<mutex> lock( _mutex );
+		_cond.wait( lock, [this]() { return _done; } );
+	}
+
+	private:
+		bool    _done;
+		mutex   _mutex;
+		CondVar _cond;
+};
@@ -2,66 +2,247 @@
 #pragma once
 
 
-struct MetaString: basic_string<uint16_t> {
-	MetaString()                                  = default;
-	MetaString( MetaString&& )                    = default;
-	MetaString( MetaString const& )               = default;
-	MetaString( basic_string<uint16_t>&& s )      : basic_string<uint16_t>( move( s ) ) {}
-	MetaString( basic_string<uint16_t> const& s ) : basic_string<uint16_t>( s ) {}
-	MetaString( string const& s )                 : basic_string<uint16_t>( s.begin(), s.end() ) {}
+// a string which may contain the meta characters of globs.  the text is kept
+// as a plain byte string, so that the strings without meta characters are
+// passed around as strings without conversions; the positions of the meta
+// characters are kept in a side table, which is empty for most strings.
+struct MetaString {
+	MetaString() = default;
+	MetaString( string const& s ): _text( s ) {}
+	MetaString( string&& s ): _text( move( s ) ) {}
 	template<class Iter>
-	MetaString( Iter bgn, Iter end )              : basic_string<uint16_t>( bgn, end ) {}
+	MetaString( Iter bgn, Iter end ): _text( bgn, end ) {}
+	explicit MetaString( char c, bool meta = false ) {
+		push_back( c, meta );
+	}
 
-	explicit operator string() const {
-		return string( cbegin(), cend() );
+	size_t size() const {
+		return _text.size();
 	}
-};
 
-inline bool operator!=( MetaString const& lhs, string rhs ) {
-	return lhs != MetaString( rhs );
-}
+	char operator[]( size_t i ) const {
+		return _text[i];
+	}
 
-uint16_t const metaMask = 1 << 15;
-uint16_t const star = '*' | metaMask;
-uint16_t const any1 = '?' | metaMask;
-uint16_t const home = '~' | metaMask;
+	bool isMeta( size_t i ) const {
+		return binary_search( _metas.begin(), _metas.end(), i );
+	}
 
-inline bool isMeta( uint16_t c ) {
-	return (c & metaMask) != 0;
-}
+	bool hasMeta() const {
+		return !_metas.empty();
+	}
+
+	bool hasMeta( size_t pos, size_t n ) const {
+		auto it = lower_bound( _metas.begin(), _metas.end(), pos );
+		return it != _metas.end() && *it < pos + n;
+	}
+
+	void reserve( size_t n ) {
+		_text.reserve( n );
+	}
+
+	void push_back( char c, bool meta = false ) {
+		if( meta ) {
+			_metas.push_back( _text.size() );
+		}
+		_text.push_back( c );
+	}
+
+	// the position of a non-meta character.
+	size_t find( char c, size_t pos = 0 ) const {
+		while( true ) {
+			pos = _text.find( c, pos );
+			if( pos == string::npos || !isMeta( pos ) ) {
+				return pos;
+			}
+			++pos;
+		}
+	}
 
-// O(#ptrn) space, O(#ptrn * #src) time wildcard matcher
-inline bool matchGlob( basic_string<uint16_t> const& ptrn, string const& src ) {
-	vector<bool> mark( ptrn.size() );
-	bool prev = true;
+	MetaString substr( size_t pos, size_t n = string::npos ) const {
+		MetaString r( _text.substr( pos, n ) );
+		size_t end = pos + r.size();
+		auto it = lower_bound( _metas.begin(), _metas.end(), pos );
+		for( ; it != _metas.end() && *it < end; ++it ) {
+			r._metas.push_back( *it - pos );
+		}
+		return r;
+	}
+
+	// the text, in which the meta characters are the plain ones.
+	string const& str() const {
+		return _text;
+	}
+
+	explicit operator string() const {
+		return _text;
+	}
+
+	friend MetaString operator+( MetaString const& lhs, MetaString const& rhs ) {
+		MetaString r( lhs );
+		r._text += rhs._text;
+		for( size_t i: rhs._metas ) {
+			r._metas.push_back( i + lhs.size() );
+		}
+		return r;
+	}
 
-	for( size_t i = 0; i < ptrn.size(); ++i ) {
-		mark[i] = prev;
-		prev &= ptrn[i] == star;
+	friend bool operator==( MetaString const& lhs, MetaString const& rhs ) {
+		return lhs._text == rhs._text && lhs._metas == rhs._metas;
 	}
 
-	for( size_t j = 0; j < src.size(); ++j ) {
-		prev = false;
+	friend bool operator!=( MetaString const& lhs, MetaString const& rhs ) {
+		return !(lhs == rhs);
+	}
+
+	private:
+		string _text;
+		vector<size_t> _metas; // sorted.
+};
+
+inline bool operator!=( MetaString const& lhs, string const& rhs ) {
+	return lhs.hasMeta() || lhs.str() != rhs;
+}
+
+// a glob pattern compiled to match many names, e.g. all the entries of a
+// directory.  the pattern is split by the stars into pieces of fixed length;
+// the first and the last pieces are anchored and the others are matched at
+// their leftmost positions, which is enough for globs.  the pieces without
+// "?" and character classes are compared with memcmp() and string::find().
+struct GlobMatcher {
+	explicit GlobMatcher( MetaString const& ptrn ) {
+		_pieces.emplace_back();
 		for( size_t i = 0; i < ptrn.size(); ++i ) {
-			bool curr;
-			if( ptrn[i] == star ) {
-				curr = prev | mark[i];
-				prev = curr;
+			Piece& piece = _pieces.back();
+			if( !ptrn.isMeta( i ) ) {
+				piece.items.push_back( Item{ literal, ptrn[i], 0 } );
+				piece.text.push_back( ptrn[i] );
+			}
+			else if( ptrn[i] == '*' ) {
+				_pieces.emplace_back();
 			}
-			else if( ptrn[i] == any1 || ptrn[i] == src[j] ) {
-				curr = prev;
-				prev = mark[i];
+			else if( ptrn[i] == '[' ) {
+				i = _class( ptrn, i );
+				piece.items.push_back( Item{ klass, '\0', _classes.size() - 1 } );
+				piece.text.push_back( '\0' );
+				piece.plain = false;
 			}
 			else {
-				curr = prev;
-				prev = false;
+				piece.items.push_back( Item{ any1, '\0', 0 } );
+				piece.text.push_back( '\0' );
+				piece.plain = false;
 			}
-			mark[i] = curr;
 		}
 	}
 
-	return prev;
-}
+	bool operator()( string const& src ) const {
+		Piece const& head = _pieces.front();
+		if( _pieces.size() == 1 ) {
+			return src.size() == head.size() && _match( head, src, 0 );
+		}
+
+		Piece const& tail = _pieces.back();
+		if( src.size() < head.size() + tail.size() ) {
+			return false;
+		}
+		if( !_match( head, src, 0 ) || !_match( tail, src, src.size() - tail.size() ) ) {
+			return false;
+		}
+
+		size_t pos = head.size();
+		size_t end = src.size() - tail.size();
+		for( size_t i = 1; i + 1 < _pieces.size(); ++i ) {
+			pos = _find( _pieces[i], src, pos, end );
+			if( pos == string::npos ) {
+				return false;
+			}
+			pos += _pieces[i].size();
+		}
+		return true;
+	}
+
+	private:
+		enum Kind: uint8_t { literal, any1, klass };
+
+		struct Item {
+			Kind kind;
+			char c;
+			size_t cls; // the index of _classes.
+		};
+
+		struct Piece {
+			Piece(): plain( true ) {}
+
+			size_t size() const {
+				return items.size();
+			}
+
+			vector<Item> items;
+			string text; // the literal characters.
+			bool plain;  // consists of literal characters only.
+		};
+
+		// parses "[...]" or "[!...]" from the meta "[" at i to the next meta
+		// "]" and returns the position of the "]".
+		size_t _class( MetaString const& ptrn, size_t i ) {
+			size_t end = i + 1;
+			while( end < ptrn.size() && !(ptrn.isMeta( end ) && ptrn[end] == ']') ) {
+				++end;
+			}
+			assert( end < ptrn.size() );
+
+			bitset<256> cls;
+			size_t j = i + 1;
+			bool neg = j < end && (ptrn[j] == '!' || ptrn[j] == '^');
+			if( neg ) {
+				++j;
+			}
+			for( ; j < end; ++j ) {
+				uint8_t lo = ptrn[j];
+				uint8_t hi = lo;
+				if( j + 2 < end && ptrn[j + 1] == '-' ) {
+					hi = ptrn[j + 2];
+					j += 2;
+				}
+				for( unsigned c = lo; c <= hi; ++c ) {
+					cls.set( c );
+				}
+			}
+			_classes.push_back( neg ? ~cls : cls );
+			return end;
+		}
+
+		bool _match( Piece const& piece, string const& src, size_t pos ) const {
+			if( piece.plain ) {
+				return memcmp( piece.text.data(), src.data() + pos, piece.size() ) == 0;
+			}
+			for( size_t i = 0; i < piece.size(); ++i ) {
+				Item const& item = piece.items[i];
+				char c = src[pos + i];
+				if( item.kind == literal ? item.c != c : item.kind == klass && !_classes[item.cls][uint8_t( c )] ) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// the leftmost position of the piece in src[pos, end).
+		size_t _find( Piece const& piece, string const& src, size_t pos, size_t end ) const {
+			if( piece.plain ) {
+				size_t r = src.find( piece.text, pos );
+				return r != string::npos && r + piece.size() <= end ? r : string::npos;
+			}
+			for( ; pos + piece.size() <= end; ++pos ) {
+				if( _match( piece, src, pos ) ) {
+					return pos;
+				}
+			}
+			return string::npos;
+		}
+
+		vector<Piece> _pieces;
+		vector<bitset<256>> _classes;
+};
 
 template<class DstIter>
 DstIter listDir( string const& root, DstIter dstIt ) {
@@ -87,18 +268,279 @@ DstIter listDir( string const& root, DstIter dstIt ) {
 	return dstIt;
 }
 
+// a cache of the directory listings for globs, which is bounded by the total
+// number of the entries.  a listing is valid while the inode and the mtime of
+// the directory are the same, so a hit costs a stat() instead of reading the
+// whole directory.
+struct DirCache {
+	using Entries = vector<tuple<string, int>>;
+
+	explicit DirCache( size_t n = 1 << 18 ): _limit( n ), _size( 0 ) {}
+
+	// throws system_error if the directory can not be read.
+	shared_ptr<Entries const> list( string const& root ) {
+		struct stat st;
+		if( stat( root.c_str(), &st ) < 0 ) {
+			throw system_error( errno, system_category() );
+		}
+
+		{
+			lock_guard<mutex> lock( _mutex );
+			auto it = _items.find( root );
+			if( it != _items.end() ) {
+				Item& item = it->second;
+				if( _same( item.st, st ) ) {
+					_lru.splice( _lru.end(), _lru, item.used );
+					return item.entries;
+				}
+				_size -= item.entries->size();
+				_lru.erase( item.used );
+				_items.erase( it );
+			}
+		}
+
+		timespec now;
+		clock_gettime( CLOCK_REALTIME, &now );
+		auto entries = make_shared<Entries>();
+		listDir( root, back_inserter( *entries ) );
+
+		// a modification within the granularity of the timestamps may not
+		// change the mtime, so recently modified directories are not kept.
+		if( st.st_mtim.tv_sec + 1 < now.tv_sec && entries->size() <= _limit ) {
+			lock_guard<mutex> lock( _mutex );
+			while( _size + entries->size() > _limit ) {
+				_evict();
+			}
+			auto r = _items.emplace( root, Item{ st, entries, _lru.end() } );
+			if( r.second ) {
+				r.first->second.used = _lru.insert( _lru.end(), &r.first->first );
+				_size += entries->size();
+			}
+		}
+		return entries;
+	}
+
+	private:
+		struct Item {
+			struct stat st;
+			shared_ptr<Entries const> entries;
+			std::list<string const*>::iterator used; // the position in _lru.
+		};
+
+		static bool _same( struct stat const& a, struct stat const& b ) {
+			return
+				a.st_dev == b.st_dev && a.st_ino == b.st_ino &&
+				a.st_mtim.tv_sec  == b.st_mtim.tv_sec &&
+				a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+		}
+
+		// drops the least recently used listing.
+		void _evict() {
+			auto it = _items.find( *_lru.front() );
+			_lru.pop_front();
+			_size -= it->second.entries->size();
+			_items.erase( it );
+		}
+
+		size_t const _limit;
+		size_t _size;
+		map<string, Item> _items;
+		std::list<string const*> _lru; // the keys of _items, the least recent first.
+		mutex _mutex;
+};
+
+// reads the tree under a directory for "**/" in parallel on the scheduler.
+// directories are opened relative to their parents and read by getdents64()
+// with large buffers, and the types of the entries are taken from d_type, so
+// the walk needs no stat() on most file systems.  symbolic links are not
+// followed.
+struct TreeWalker {
+	struct Node {
+		string path;                     // relative to the root, ends with "/".
+		vector<string> names;            // the non-directories which match.
+		vector<unique_ptr<Node>> children;
+	};
+
+	// if match is null, no names are collected.
+	explicit TreeWalker( GlobMatcher const* m ): _match( m ) {}
+
+	unique_ptr<Node> walk( string const& root ) {
+		unique_ptr<Node> node( new Node() );
+		int fd = open( root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+		if( fd >= 0 ) {
+			_walk( fd, *node );
+		}
+		return node;
+	}
+
+	private:
+		// takes the ownership of fd.
+		void _walk( int fd, Node& node ) {
+			auto closer = scopeExit( bind( close, fd ) );
+			_read( fd, node );
+
+			vector<shared_ptr<Scheduler::Task>> tasks;
+			for( size_t i = 0; i + 1 < node.children.size(); ++i ) {
+				Node* child = node.children[i].get();
+				tasks.push_back( Scheduler::instance().spawn( [=]() -> void {
+					_open( fd, *child );
+				} ) );
+			}
+			if( !node.children.empty() ) {
+				_open( fd, *node.children.back() );
+			}
+			for( auto& task: tasks ) {
+				task->join();
+			}
+		}
+
+		void _open( int parent, Node& node ) {
+			string name( node.path, node.path.rfind( '/', node.path.size() - 2 ) + 1 );
+			name.pop_back();
+			int fd = openat( parent, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC );
+			if( fd >= 0 ) {
+				_walk( fd, node );
+			}
+		}
+
+		void _entry( int fd, Node& node, char const* name, int type ) {
+			if( strcmp( name, "." ) == 0 || strcmp( name, ".." ) == 0 ) {
+				return;
+			}
+			if( type == DT_UNKNOWN ) {
+				struct stat st;
+				if( fstatat( fd, name, &st, AT_SYMLINK_NOFOLLOW ) < 0 ) {
+					return;
+				}
+				type = S_ISDIR( st.st_mode ) ? DT_DIR : S_ISLNK( st.st_mode ) ? DT_LNK : DT_REG;
+			}
+
+			if( type == DT_DIR ) {
+				node.children.emplace_back( new Node() );
+				node.children.back()->path = node.path + name + "/";
+			}
+			if( _match != nullptr && !(type & DT_DIR) && (*_match)( name ) ) {
+				node.names.push_back( name );
+			}
+		}
+
+#if defined( __linux__ )
+		void _read( int fd, Node& node ) {
+			struct linux_dirent64 {
+				uint64_t d_ino;
+				int64_t  d_off;
+				uint16_t d_reclen;
+				uint8_t  d_type;
+				char     d_name[1];
+			};
+
+			vector<char> buf( 1 << 16 );
+			while( true ) {
+				long n = syscall( SYS_getdents64, fd, buf.data(), buf.size() );
+				if( n <= 0 ) {
+					break;
+				}
+				for( long offset = 0; offset < n; ) {
+					linux_dirent64* entry = reinterpret_cast<linux_dirent64*>( buf.data() + offset );
+					_entry( fd, node, entry->d_name, entry->d_type );
+					offset += entry->d_reclen;
+				}
+			}
+		}
+#else
+		void _read( int fd, Node& node ) {
+			DIR* dir = fdopendir( dup( fd ) );
+			if( dir == nullptr ) {
+				return;
+			}
+			auto closer = scopeExit( bind( closedir, dir ) );
+			while( dirent* entry = readdir( dir ) ) {
+				_entry( fd, node, entry->d_name, entry->d_type );
+			}
+		}
+#endif
+
+		GlobMatcher const* _match;
+};
+
+template<class DstIter>
+DstIter expandGlobRec( DirCache&, string const&, MetaString const&, DstIter );
+
+// "**/rest" matches rest in root and all the directories under it.
+template<class DstIter>
+DstIter expandGlobTree( DirCache& cache, string const& root, MetaString const& rest, DstIter dstIt ) {
+	bool leaf = rest.find( '/' ) == string::npos;
+	unique_ptr<GlobMatcher> match( leaf && rest.size() > 0 ? new GlobMatcher( rest ) : nullptr );
+	unique_ptr<TreeWalker::Node> tree = TreeWalker( match.get() ).walk( root );
+
+	// the results are in the order of the walk regardless of the parallelism.
+	vector<TreeWalker::Node const*> stack{ tree.get() };
+	while( !stack.empty() ) {
+		TreeWalker::Node const* node = stack.back();
+		stack.pop_back();
+		if( rest.size() == 0 ) {
+			if( node != tree.get() ) {
+				*dstIt++ = root + node->path;
+			}
+		}
+		else if( leaf ) {
+			for( auto const& name: node->names ) {
+				*dstIt++ = root + node->path + name;
+			}
+		}
+		else {
+			dstIt = expandGlobRec( cache, root + node->path, rest, dstIt );
+		}
+		for( auto it = node->children.rbegin(); it != node->children.rend(); ++it ) {
+			stack.push_back( it->get() );
+		}
+	}
+	return dstIt;
+}
+
 template<class DstIter>
-DstIter expandGlobRec( string const& root, basic_string<uint16_t> const& ptrn, DstIter dstIt ) {
+DstIter expandGlobRec( DirCache& cache, string const& root, MetaString const& ptrn, DstIter dstIt ) {
+	// the segments without meta characters are joined and resolved by a
+	// stat() instead of listing the directories.
+	size_t lit = 0;
+	while( true ) {
+		size_t slash = ptrn.find( '/', lit );
+		if( slash == string::npos || ptrn.hasMeta( lit, slash - lit ) ) {
+			break;
+		}
+		lit = slash + 1;
+	}
+	if( lit > 0 ) {
+		string dir = root + ptrn.str().substr( 0, lit );
+		struct stat st;
+		if( stat( dir.c_str(), &st ) < 0 || !S_ISDIR( st.st_mode ) ) {
+			return dstIt;
+		}
+		if( lit == ptrn.size() ) {
+			*dstIt++ = dir;
+			return dstIt;
+		}
+		return expandGlobRec( cache, dir, ptrn.substr( lit ), dstIt );
+	}
+
 	size_t slash = ptrn.find( '/' );
-	if( slash == basic_string<uint16_t>::npos ) {
-		vector<tuple<string, int>> dirs;
+	if( slash == string::npos && !ptrn.hasMeta() ) {
+		string file = root + ptrn.str();
+		struct stat st;
+		if( stat( file.c_str(), &st ) == 0 && !S_ISDIR( st.st_mode ) ) {
+			*dstIt++ = file;
+		}
+	}
+	else if( slash == string::npos ) {
+		shared_ptr<DirCache::Entries const> dirs = make_shared<DirCache::Entries>();
 		try {
-			listDir( root, back_inserter( dirs ) );
+			dirs = cache.list( root );
 		}
 		catch( system_error const& ) {}
 
-		for( auto const& dir: dirs ) {
-			if( !(get<1>( dir ) & DT_DIR) && matchGlob( ptrn, get<0>( dir ) ) ) {
+		GlobMatcher match( ptrn );
+		for( auto const& dir: *dirs ) {
+			if( !(get<1>( dir ) & DT_DIR) && match( get<0>( dir ) ) ) {
 				*dstIt++ = root + get<0>( dir );
 			}
 		}
@@ -108,24 +550,24 @@ DstIter expandGlobRec( string const& root, basic_string<uint16_t> const& ptrn, D
 		auto base = ptrn.substr( 0, slash );
 		auto rest = ptrn.substr( slash + 1 );
 
-		if( base == basic_string<uint16_t>{ '.' } ||
-		    base == basic_string<uint16_t>{ '.', '.' } ) {
-			dstIt = expandGlobRec( root + string( base.begin(), base.end() ) + "/", rest, dstIt );
+		if( base.size() == 2 && base.isMeta( 0 ) && base.isMeta( 1 ) && base.str() == "**" ) {
+			dstIt = expandGlobTree( cache, root, rest, dstIt );
 		}
 		else {
-			vector<tuple<string, int>> dirs;
+			shared_ptr<DirCache::Entries const> dirs = make_shared<DirCache::Entries>();
 			try {
-				listDir( root, back_inserter( dirs ) );
+				dirs = cache.list( root );
 			}
 			catch( system_error const& ) {}
 
-			for( auto const& dir: dirs ) {
-				if( (get<1>( dir ) & DT_DIR) && matchGlob( base, get<0>( dir ) ) ) {
+			GlobMatcher match( base );
+			for( auto const& dir: *dirs ) {
+				if( (get<1>( dir ) & DT_DIR) && match( get<0>( dir ) ) ) {
 					if( rest.size() == 0 ) {
 						*dstIt++ = root + get<0>( dir ) + "/";
 					}
 					else {
-						dstIt = expandGlobRec( root + get<0>( dir ) + "/", rest, dstIt );
+						dstIt = expandGlobRec( cache, root + get<0>( dir ) + "/", rest, dstIt );
 					}
 				}
 			}
@@ -136,17 +578,17 @@ DstIter expandGlobRec( string const& root, basic_string<uint16_t> const& ptrn, D
 }
 
 template<class DstIter>
-DstIter expandGlob( MetaString const& src, string const& cwd, DstIter dstIt ) {
-	if( !any_of( src.begin(), src.end(), isMeta ) ) {
-		*dstIt++ = string( src );
+DstIter expandGlob( MetaString const& src, string const& cwd, DirCache& cache, DstIter dstIt ) {
+	if( !src.hasMeta() ) {
+		*dstIt++ = src.str();
 		return dstIt;
 	}
 
 	assert( src.size() > 0 );
 	if( src[0] == '/' ) {
-		return expandGlobRec( "/", src.substr( 1 ), dstIt );
+		return expandGlobRec( cache, "/", src.substr( 1 ), dstIt );
 	}
 	else {
-		return expandGlobRec( cwd + "/", src, dstIt );
+		return expandGlobRec( cache, cwd + "/", src, dstIt );
 	}
 }
@@ -2,23 +2,38 @@
 
 #include "pch.hpp"
 #include "misc.hpp"
+#include "fiber.hpp"
+#include "scheduler.hpp"
 #include "unix.hpp"
+#include "channel.hpp"
 #include "glob.hpp"
+#include "value.hpp"
 #include "ast.hpp"
 #include "parser.hpp"
 #include "annotate.hpp"
 #include "eval.hpp"
+#include "regex.hpp"
+#include "str.hpp"
+#include "builtins.hpp"
 
 
 // toriaezu tekito-
 struct TaskManager: Evaluator::Listener {
 	using ArgIter = Evaluator::ArgIter;
 
-	TaskManager( char** ab, char** ae, string const& c ):
-		_evaluator( this ),
+	TaskManager( char** ab, char** ae, string const& c, bool f ):
+		_evaluator( this, f ),
 		_argsB( ab ),
 		_argsE( ae ),
-		_cwd( c ) {
+		_cwd( c ),
+		_stdin( 0 ) {
+		builtins::register_( _evaluator.builtins );
+	}
+
+	// leaves stdin where the program stopped reading, as a program which
+	// reads it without a buffer does.
+	~TaskManager() {
+		_stdin.reader->seekBack();
 	}
 
 	int evaluate( istream& ifs ) {
@@ -28,24 +43,24 @@ struct TaskManager: Evaluator::Listener {
 		annotate( ast.get(), alocal );
 
 		auto elocal = make_shared<Evaluator::Local>();
-		elocal->vars.resize( alocal.vars.size() );
-		elocal->cwd = _cwd;
+		elocal->resize( alocal.vars.size() );
+		elocal->cwd = make_shared<string const>( _cwd );
 
-		return _evaluator.evalStmt( ast.get(), elocal, 0, 1 );
+		return _evaluator.evalStmt( ast.get(), elocal, _stdin, 1 );
 	}
 
 	void join() {
 		while( true ) {
-			vector<thread> tmp;
+			vector<shared_ptr<Scheduler::Task>> tmp;
 			{
 				lock_guard<mutex> lock( _mutex );
-				swap( tmp, _threads );
+				swap( tmp, _tasks );
 			}
 			if( tmp.empty() ) {
 				break;
 			}
 			for( auto& t: tmp ) {
-				t.join();
+				t->join();
 			}
 		}
 	}
@@ -70,15 +85,24 @@ struct TaskManager: Evaluator::Listener {
 				return evaluate( ifs );
 			}
 
-			pid_t pid = forkExec( argsB, argsE, ifd, ofd, cwd );
+			string file = _commands.find( argsB[0] );
+			if( file.empty() ) {
+				return 1;
+			}
+			pid_t pid = forkExec( file, argsB, argsE, ifd, ofd, cwd );
+			if( pid < 0 ) {
+				return 1;
+			}
 			int status;
+			Scheduler::Blocking blocking;
+			waitExited( pid );
 			checkSysCall( waitpid( pid, &status, 0 ) );
 			return WEXITSTATUS( status );
 		}
 
-		virtual void onBgTask( thread&& thr ) override {
+		virtual void onBgTask( shared_ptr<Scheduler::Task> task ) override {
 			lock_guard<mutex> lock( _mutex );
-			_threads.push_back( move( thr ) );
+			_tasks.push_back( move( task ) );
 		}
 
 	private:
@@ -86,13 +110,27 @@ struct TaskManager: Evaluator::Listener {
 		char** _argsB;
 		char** _argsE;
 		string _cwd;
+		// shared by all the programs, including the imported ones.
+		Input _stdin;
+		CommandHash _commands;
 		mutex _mutex;
-		vector<thread> _threads;
+		vector<shared_ptr<Scheduler::Task>> _tasks;
 };
 
 int main( int argc, char** argv ) {
+	bool fibers = false;
 	int opt;
-	while( opt = getopt( argc, argv, "" ), opt != -1 ) {
+	// the options after the script name are the script's.  unknown ones are
+	// warned by getopt() and ignored.
+	while( opt = getopt( argc, argv, "+fj:" ), opt != -1 ) {
+		switch( opt ) {
+			case 'f':
+				fibers = true;
+				break;
+			case 'j':
+				Scheduler::instance().setMaxWorkers( strtoul( optarg, nullptr, 10 ) );
+				break;
+		}
 	}
 
 	struct sigaction sa;
@@ -104,11 +142,18 @@ int main( int argc, char** argv ) {
 	array<char, MAXPATHLEN> buf;
 	getcwd( buf.data(), buf.size() );
 
+	int status = 0;
 	if( optind < argc ) {
-		TaskManager taskMan( &argv[optind + 1], &argv[argc], buf.data() );
+		TaskManager taskMan( &argv[optind + 1], &argv[argc], buf.data(), fibers );
 		ifstream ifs( argv[optind] );
 		try {
-			taskMan.evaluate( ifs );
+			// "return" at the top level exits with the value.
+			try {
+				taskMan.evaluate( ifs );
+			}
+			catch( Evaluator::ReturnException const& e ) {
+				status = e.retv;
+			}
 			taskMan.join();
 		}
 		catch( SyntaxError const& err ) {
@@ -136,7 +181,7 @@ int main( int argc, char** argv ) {
 	}
 	*/
 
-	return 0;
+	return status & 0xff;
 }
 
 
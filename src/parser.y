@@ -205,18 +205,18 @@ arith_prim
 	| '[' stmt_seq ']'					{ $$ = new Subst( $2 ); }
 
 symbols
-	: '+'								{ $$ = new Word( basic_string<uint16_t>{ '+' } ); }
-	| '-'								{ $$ = new Word( basic_string<uint16_t>{ '-' } ); }
-	| '*'								{ $$ = new Word( basic_string<uint16_t>{ star } ); }
-	| '/'								{ $$ = new Word( basic_string<uint16_t>{ '/' } ); }
-	| '%'								{ $$ = new Word( basic_string<uint16_t>{ '%' } ); }
-	| '<'								{ $$ = new Word( basic_string<uint16_t>{ '<' } ); }
-	| '>'								{ $$ = new Word( basic_string<uint16_t>{ '>' } ); }
-	| ':'								{ $$ = new Word( basic_string<uint16_t>{ ':' } ); }
-	| TK_EQ								{ $$ = new Word( basic_string<uint16_t>{ '=', '=' } ); }
-	| TK_NE								{ $$ = new Word( basic_string<uint16_t>{ '!', '=' } ); }
-	| TK_LE								{ $$ = new Word( basic_string<uint16_t>{ '<', '=' } ); }
-	| TK_GE								{ $$ = new Word( basic_string<uint16_t>{ '>', '=' } ); }
+	: '+'								{ $$ = new Word( MetaString( '+' ) ); }
+	| '-'								{ $$ = new Word( MetaString( '-' ) ); }
+	| '*'								{ $$ = new Word( MetaString( '*', true ) ); }
+	| '/'								{ $$ = new Word( MetaString( '/' ) ); }
+	| '%'								{ $$ = new Word( MetaString( '%' ) ); }
+	| '<'								{ $$ = new Word( MetaString( '<' ) ); }
+	| '>'								{ $$ = new Word( MetaString( '>' ) ); }
+	| ':'								{ $$ = new Word( MetaString( ':' ) ); }
+	| TK_EQ								{ $$ = new Word( MetaString( string( "==" ) ) ); }
+	| TK_NE								{ $$ = new Word( MetaString( string( "!=" ) ) ); }
+	| TK_LE								{ $$ = new Word( MetaString( string( "<=" ) ) ); }
+	| TK_GE								{ $$ = new Word( MetaString( string( ">=" ) ) ); }
 
 %%
 
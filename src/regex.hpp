@@ -0,0 +1,575 @@
+// (c) Yasuhiro Fujii <y-fujii at mimosa-pudica.net> / 2-clause BSD license
+#pragma once
+
+
+// a regular expression of the ECMAScript syntax of std::regex, which is
+// matched in linear time where possible.  the pattern is compiled to a Thompson
+// NFA, which is run as a DFA built lazily and cached.  the patterns which need
+// backtracking (back references, assertions, etc.) and the replacements, which
+// need the submatches, are left to std::regex.  an instance must not be shared
+// by threads, since matching updates the cache.
+struct Regex {
+	explicit Regex( string const& ptrn ):
+		_re( ptrn ), _bol( false ), _eol( false ) {
+		try {
+			Parser parser( ptrn );
+			unique_ptr<Node> node = parser.parse();
+			_strip( node );
+			_prefix = _literalPrefix( node.get() );
+			_nfa.compile( node.get() );
+			_anchored.reset( new Dfa( _nfa, false ) );
+			_floating.reset( new Dfa( _nfa, true ) );
+		}
+		catch( Unsupported const& ) {
+			_anchored.reset();
+			_floating.reset();
+		}
+	}
+
+	// same as regex_match().
+	bool match( string const& src ) const {
+		if( !_anchored ) {
+			return regex_match( src, _re );
+		}
+		if( src.compare( 0, _prefix.size(), _prefix ) != 0 ) {
+			return false;
+		}
+		return _anchored->run( src, 0, true );
+	}
+
+	// same as regex_search().
+	bool search( string const& src ) const {
+		if( !_anchored ) {
+			return regex_search( src, _re );
+		}
+		if( _bol ) {
+			return src.compare( 0, _prefix.size(), _prefix ) == 0 && _anchored->run( src, 0, _eol );
+		}
+		size_t pos = src.find( _prefix );
+		return pos != string::npos && _floating->run( src, pos, _eol );
+	}
+
+	// same as regex_replace().  the lines without matches are not passed to
+	// std::regex.
+	string replace( string const& src, string const& fmt ) const {
+		return search( src ) ? regex_replace( src, _re, fmt ) : src;
+	}
+
+	private:
+		struct Unsupported {
+		};
+
+		using CharSet = bitset<256>;
+
+		static int _first( CharSet const& cs ) {
+			for( int i = 0; i < 256; ++i ) {
+				if( cs[i] ) {
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		struct Node {
+			enum Kind { set, cat, alt, rep, bol, eol };
+
+			explicit Node( Kind k ): kind( k ), min( 0 ), max( 0 ) {}
+
+			Kind kind;
+			CharSet chars;
+			int min;
+			int max; // -1 for infinity.
+			vector<unique_ptr<Node>> children;
+		};
+
+		// the subset of the ECMAScript grammar which has no backtracking.
+		struct Parser {
+			explicit Parser( string const& s ): _src( s ), _pos( 0 ) {}
+
+			unique_ptr<Node> parse() {
+				unique_ptr<Node> node = _alt();
+				if( _pos != _src.size() ) {
+					throw Unsupported();
+				}
+				return node;
+			}
+
+			private:
+				bool _eof() const {
+					return _pos >= _src.size();
+				}
+
+				char _peek() const {
+					return _src[_pos];
+				}
+
+				unique_ptr<Node> _alt() {
+					unique_ptr<Node> node( new Node( Node::alt ) );
+					node->children.push_back( _cat() );
+					while( !_eof() && _peek() == '|' ) {
+						++_pos;
+						node->children.push_back( _cat() );
+					}
+					return node;
+				}
+
+				unique_ptr<Node> _cat() {
+					unique_ptr<Node> node( new Node( Node::cat ) );
+					while( !_eof() && _peek() != '|' && _peek() != ')' ) {
+						node->children.push_back( _repeat() );
+					}
+					return node;
+				}
+
+				unique_ptr<Node> _repeat() {
+					unique_ptr<Node> node = _atom();
+					while( !_eof() ) {
+						int min, max;
+						char c = _peek();
+						if( c == '*' ) {
+							min = 0, max = -1;
+							++_pos;
+						}
+						else if( c == '+' ) {
+							min = 1, max = -1;
+							++_pos;
+						}
+						else if( c == '?' ) {
+							min = 0, max = 1;
+							++_pos;
+						}
+						else if( c == '{' ) {
+							++_pos;
+							min = max = _number();
+							if( !_eof() && _peek() == ',' ) {
+								++_pos;
+								max = !_eof() && _peek() == '}' ? -1 : _number();
+							}
+							if( _eof() || _peek() != '}' || (max >= 0 && max < min) || min > 256 || max > 256 ) {
+								throw Unsupported();
+							}
+							++_pos;
+						}
+						else {
+							break;
+						}
+						// the laziness does not change whether a string matches.
+						if( !_eof() && _peek() == '?' ) {
+							++_pos;
+						}
+						if( node->kind == Node::bol || node->kind == Node::eol ) {
+							throw Unsupported();
+						}
+
+						unique_ptr<Node> rep( new Node( Node::rep ) );
+						rep->min = min;
+						rep->max = max;
+						rep->children.push_back( move( node ) );
+						node = move( rep );
+					}
+					return node;
+				}
+
+				int _number() {
+					int n = 0;
+					size_t bgn = _pos;
+					while( !_eof() && isdigit( uint8_t( _peek() ) ) && n <= 256 ) {
+						n = n * 10 + (_peek() - '0');
+						++_pos;
+					}
+					if( _pos == bgn ) {
+						throw Unsupported();
+					}
+					return n;
+				}
+
+				unique_ptr<Node> _atom() {
+					char c = _src[_pos++];
+					switch( c ) {
+						case '(': {
+							if( !_eof() && _peek() == '?' ) {
+								if( _src.compare( _pos, 2, "?:" ) != 0 ) {
+									throw Unsupported();
+								}
+								_pos += 2;
+							}
+							unique_ptr<Node> node = _alt();
+							if( _eof() || _peek() != ')' ) {
+								throw Unsupported();
+							}
+							++_pos;
+							return node;
+						}
+						case '^':
+							return unique_ptr<Node>( new Node( Node::bol ) );
+						case '$':
+							return unique_ptr<Node>( new Node( Node::eol ) );
+						case '.': {
+							unique_ptr<Node> node( new Node( Node::set ) );
+							node->chars.set();
+							node->chars.reset( '\n' );
+							node->chars.reset( '\r' );
+							return node;
+						}
+						case '[':
+							return _class();
+						case '\\': {
+							unique_ptr<Node> node( new Node( Node::set ) );
+							node->chars = _escape();
+							return node;
+						}
+						case ')': case ']': case '}': case '{': case '*': case '+': case '?':
+							throw Unsupported();
+						default: {
+							unique_ptr<Node> node( new Node( Node::set ) );
+							node->chars.set( uint8_t( c ) );
+							return node;
+						}
+					}
+				}
+
+				unique_ptr<Node> _class() {
+					unique_ptr<Node> node( new Node( Node::set ) );
+					bool neg = !_eof() && _peek() == '^';
+					if( neg ) {
+						++_pos;
+					}
+					if( !_eof() && _peek() == ']' ) {
+						throw Unsupported();
+					}
+
+					while( true ) {
+						if( _eof() ) {
+							throw Unsupported();
+						}
+						if( _peek() == ']' ) {
+							++_pos;
+							break;
+						}
+						if( _src.compare( _pos, 2, "[:" ) == 0 || _src.compare( _pos, 2, "[." ) == 0 || _src.compare( _pos, 2, "[=" ) == 0 ) {
+							throw Unsupported();
+						}
+
+						CharSet lo = _classAtom();
+						if( _pos + 1 < _src.size() && _peek() == '-' && _src[_pos + 1] != ']' ) {
+							++_pos;
+							CharSet hi = _classAtom();
+							if( lo.count() != 1 || hi.count() != 1 ) {
+								throw Unsupported();
+							}
+							int l = _first( lo );
+							int h = _first( hi );
+							if( l > h ) {
+								throw Unsupported();
+							}
+							for( int i = l; i <= h; ++i ) {
+								node->chars.set( i );
+							}
+						}
+						else {
+							node->chars |= lo;
+						}
+					}
+
+					if( neg ) {
+						node->chars.flip();
+					}
+					return node;
+				}
+
+				CharSet _classAtom() {
+					char c = _src[_pos++];
+					if( c == '\\' ) {
+						return _escape();
+					}
+					CharSet cs;
+					cs.set( uint8_t( c ) );
+					return cs;
+				}
+
+				CharSet _escape() {
+					if( _eof() ) {
+						throw Unsupported();
+					}
+					char c = _src[_pos++];
+					CharSet cs;
+					auto range = [&]( char l, char h ) -> void {
+						for( int i = uint8_t( l ); i <= uint8_t( h ); ++i ) {
+							cs.set( i );
+						}
+					};
+					switch( c ) {
+						case 'd': case 'D':
+							range( '0', '9' );
+							break;
+						case 'w': case 'W':
+							range( '0', '9' );
+							range( 'A', 'Z' );
+							range( 'a', 'z' );
+							cs.set( '_' );
+							break;
+						case 's': case 'S':
+							for( char s: string( " \t\n\v\f\r" ) ) {
+								cs.set( uint8_t( s ) );
+							}
+							break;
+						case 't': cs.set( '\t' ); break;
+						case 'n': cs.set( '\n' ); break;
+						case 'r': cs.set( '\r' ); break;
+						case 'v': cs.set( '\v' ); break;
+						case 'f': cs.set( '\f' ); break;
+						default:
+							// back references, word boundaries, \x, \u, \c etc.
+							if( isalnum( uint8_t( c ) ) ) {
+								throw Unsupported();
+							}
+							cs.set( uint8_t( c ) );
+					}
+					if( c == 'D' || c == 'W' || c == 'S' ) {
+						cs.flip();
+					}
+					return cs;
+				}
+
+				string const& _src;
+				size_t _pos;
+		};
+
+		// a Thompson NFA.  the states of kind chr consume a character of
+		// chars[set]; split goes to both outs without consuming.
+		struct Nfa {
+			struct State {
+				enum Kind { chr, split, match };
+
+				Kind kind;
+				int set;
+				int out0;
+				int out1;
+			};
+
+			void compile( Node const* node ) {
+				int end = _state( State::match, -1, -1, -1 );
+				start = _compile( node, end );
+				if( states.size() > 1 << 16 ) {
+					throw Unsupported();
+				}
+			}
+
+			vector<State> states;
+			vector<CharSet> sets;
+			int start;
+
+			private:
+				int _state( State::Kind kind, int set, int out0, int out1 ) {
+					states.push_back( State{ kind, set, out0, out1 } );
+					return states.size() - 1;
+				}
+
+				// returns the entry of the node which continues to next.
+				int _compile( Node const* node, int next ) {
+					if( states.size() > 1 << 16 ) {
+						throw Unsupported();
+					}
+					switch( node->kind ) {
+						case Node::set:
+							sets.push_back( node->chars );
+							return _state( State::chr, sets.size() - 1, next, -1 );
+						case Node::cat:
+							for( auto it = node->children.rbegin(); it != node->children.rend(); ++it ) {
+								next = _compile( it->get(), next );
+							}
+							return next;
+						case Node::alt: {
+							int entry = _compile( node->children.back().get(), next );
+							for( auto it = node->children.rbegin() + 1; it != node->children.rend(); ++it ) {
+								entry = _state( State::split, -1, _compile( it->get(), next ), entry );
+							}
+							return entry;
+						}
+						case Node::rep: {
+							Node const* child = node->children[0].get();
+							int entry = next;
+							if( node->max < 0 ) {
+								// a loop; the split is patched after the body.
+								int loop = _state( State::split, -1, -1, next );
+								int body = _compile( child, loop );
+								states[loop].out0 = body;
+								entry = loop;
+							}
+							else {
+								for( int i = node->min; i < node->max; ++i ) {
+									entry = _state( State::split, -1, _compile( child, entry ), next );
+									next = entry;
+								}
+							}
+							for( int i = 0; i < node->min; ++i ) {
+								entry = _compile( child, entry );
+							}
+							return entry;
+						}
+						default:
+							throw Unsupported();
+					}
+				}
+		};
+
+		// the DFA of which states are the sets of the NFA states, built while
+		// matching.  floating ones restart the NFA at every position.
+		struct Dfa {
+			Dfa( Nfa const& n, bool f ): _nfa( n ), _floating( f ) {
+				_start = _intern( _closure( vector<int>{ _nfa.start } ) );
+			}
+
+			// returns true iff a match ends at the end, or anywhere if !atEnd.
+			bool run( string const& src, size_t pos, bool atEnd ) {
+				int s = _start;
+				for( ; pos < src.size(); ++pos ) {
+					if( !atEnd && _accept[s] ) {
+						return true;
+					}
+					int t = _next[s][uint8_t( src[pos] )];
+					if( t == unknown ) {
+						t = _step( s, uint8_t( src[pos] ) );
+						if( t != dead && _next.size() > maxStates ) {
+							// the cache is full; start over from the current state.
+							vector<int> curr = _sets[t];
+							_clear();
+							t = _intern( move( curr ) );
+						}
+					}
+					if( t == dead ) {
+						return false;
+					}
+					s = t;
+				}
+				return _accept[s];
+			}
+
+			private:
+				enum { unknown = -1, dead = -2, maxStates = 4096 };
+
+				vector<int> _closure( vector<int> const& src ) const {
+					vector<int> dst;
+					vector<bool> seen( _nfa.states.size() );
+					vector<int> stack( src.rbegin(), src.rend() );
+					while( !stack.empty() ) {
+						int i = stack.back();
+						stack.pop_back();
+						if( seen[i] ) {
+							continue;
+						}
+						seen[i] = true;
+						Nfa::State const& st = _nfa.states[i];
+						if( st.kind == Nfa::State::split ) {
+							stack.push_back( st.out1 );
+							stack.push_back( st.out0 );
+						}
+						else {
+							dst.push_back( i );
+						}
+					}
+					sort( dst.begin(), dst.end() );
+					return dst;
+				}
+
+				int _step( int s, uint8_t c ) {
+					vector<int> next;
+					for( int i: _sets[s] ) {
+						Nfa::State const& st = _nfa.states[i];
+						if( st.kind == Nfa::State::chr && _nfa.sets[st.set][c] ) {
+							next.push_back( st.out0 );
+						}
+					}
+					if( _floating ) {
+						next.push_back( _nfa.start );
+					}
+					int t = next.empty() ? dead : _intern( _closure( next ) );
+					_next[s][c] = t;
+					return t;
+				}
+
+				int _intern( vector<int>&& set ) {
+					auto it = _ids.find( set );
+					if( it != _ids.end() ) {
+						return it->second;
+					}
+					bool accept = any_of( set.begin(), set.end(), [&]( int i ) {
+						return _nfa.states[i].kind == Nfa::State::match;
+					} );
+					int id = _sets.size();
+					_ids.emplace( set, id );
+					_sets.push_back( move( set ) );
+					_accept.push_back( accept );
+					_next.emplace_back();
+					_next.back().fill( unknown );
+					return id;
+				}
+
+				void _clear() {
+					vector<int> start = move( _sets[_start] );
+					_ids.clear();
+					_sets.clear();
+					_accept.clear();
+					_next.clear();
+					_start = _intern( move( start ) );
+				}
+
+				Nfa const& _nfa;
+				bool const _floating;
+				int _start;
+				map<vector<int>, int> _ids;
+				vector<vector<int>> _sets;
+				vector<bool> _accept;
+				vector<array<int, 256>> _next;
+		};
+
+		// takes the anchors at the ends of the whole pattern.  the others are
+		// not supported.
+		void _strip( unique_ptr<Node>& node ) {
+			if( node->children.size() == 1 ) {
+				Node* cat = node->children[0].get();
+				auto& cs = cat->children;
+				if( !cs.empty() && cs.front()->kind == Node::bol ) {
+					_bol = true;
+					cs.erase( cs.begin() );
+				}
+				if( !cs.empty() && cs.back()->kind == Node::eol ) {
+					_eol = true;
+					cs.pop_back();
+				}
+			}
+			_check( node.get() );
+		}
+
+		static void _check( Node const* node ) {
+			if( node->kind == Node::bol || node->kind == Node::eol ) {
+				throw Unsupported();
+			}
+			for( auto const& child: node->children ) {
+				_check( child.get() );
+			}
+		}
+
+		// the characters which every match starts with.
+		static string _literalPrefix( Node const* node ) {
+			string prefix;
+			if( node->children.size() != 1 ) {
+				return prefix;
+			}
+			for( auto const& child: node->children[0]->children ) {
+				if( child->kind != Node::set || child->chars.count() != 1 ) {
+					break;
+				}
+				prefix += char( _first( child->chars ) );
+			}
+			return prefix;
+		}
+
+		regex _re;
+		Nfa _nfa;
+		bool _bol;
+		bool _eol;
+		string _prefix;
+		unique_ptr<Dfa> _anchored;
+		unique_ptr<Dfa> _floating;
+};
@@ -0,0 +1,272 @@
+// (c) Yasuhiro Fujii <y-fujii at mimosa-pudica.net> / 2-clause BSD license
+#pragma once
+
+
+// work-stealing thread pool which runs the concurrent parts of rish programs.
+// a worker which waits for other stages (see Blocking) or runs a background job
+// does not count against the limit of workers, so that neither a pipeline nor a
+// background job can starve the pool.
+struct Scheduler {
+	struct Worker;
+
+	struct Task {
+		Task( Task const& ) = delete;
+		Task& operator=( Task const& ) = delete;
+
+		Task( function<void ()>&& f, uint64_t i ):
+			id( i ), _func( move( f ) ), _state( queued ) {
+		}
+
+		// runs the task if nobody has started it yet.
+		bool tryRun() {
+			int expected = queued;
+			if( !_state.compare_exchange_strong( expected, running ) ) {
+				return false;
+			}
+
+			auto notifier = scopeExit( [this]() -> void {
+				lock_guard<mutex> lock( _mutex );
+				_state = done;
+				_cond.notify_all();
+			} );
+			function<void ()> func = move( _func );
+			func();
+			return true;
+		}
+
+		// runs the task on the caller if no worker has started it, or waits
+		// for the completion.
+		void join() {
+			if( tryRun() ) {
+				return;
+			}
+
+			Blocking blocking;
+			unique_lock<mutex> lock( _mutex );
+			_cond.wait( lock, [this]() { return _state == done; } );
+		}
+
+		uint64_t const id;
+
+		private:
+			enum { queued, running, done };
+
+			function<void ()> _func;
+			atomic<int> _state;
+			mutex _mutex;
+			CondVar _cond;
+	};
+
+	// marks the current worker as waiting for others during the lifetime.
+	// fibers never block the thread by themselves, so they are ignored.
+	struct Blocking {
+		Blocking( Blocking const& ) = delete;
+		Blocking& operator=( Blocking const& ) = delete;
+
+		Blocking(): _worker( _current() ) {
+			if( _worker == nullptr || _worker->blocking || FiberLoop::running() ) {
+				_worker = nullptr;
+				return;
+			}
+
+			_worker->blocking = true;
+			Scheduler& self = instance();
+			--self._running;
+			if( self._pending > 0 ) {
+				self._wakeOrGrow();
+			}
+		}
+
+		~Blocking() {
+			if( _worker == nullptr ) {
+				return;
+			}
+
+			_worker->blocking = false;
+			++instance()._running;
+		}
+
+		private:
+			Worker* _worker;
+	};
+
+	struct Worker {
+		Worker(): blocking( false ) {}
+
+		bool blocking;
+		deque<shared_ptr<Task>> tasks;
+		std::mutex mutex;
+	};
+
+	static Scheduler& instance() {
+		// intentionally leaked: workers may outlive main().
+		static Scheduler* self = new Scheduler();
+		return *self;
+	}
+
+	// sets the maximum number of workers which run simultaneously.  0 means
+	// the number of hardware threads.
+	void setMaxWorkers( size_t n ) {
+		if( n == 0 ) {
+			n = max( thread::hardware_concurrency(), 1u );
+		}
+		lock_guard<mutex> lock( _mutex );
+		_maxRunning = n;
+	}
+
+	shared_ptr<Task> spawn( function<void ()> func ) {
+		auto task = make_shared<Task>( move( func ), ++_lastId );
+		if( Worker* worker = _current() ) {
+			lock_guard<mutex> lock( worker->mutex );
+			worker->tasks.push_back( task );
+		}
+		else {
+			lock_guard<mutex> lock( _mutex );
+			_global.push_back( task );
+		}
+		++_pending;
+		_wakeOrGrow();
+		return task;
+	}
+
+	private:
+		Scheduler(): _running( 0 ), _pending( 0 ), _lastId( 0 ), _idle( 0 ) {
+			setMaxWorkers( 0 );
+		}
+
+		static Worker*& _current() {
+			static __thread Worker* worker = nullptr;
+			return worker;
+		}
+
+		void _wakeOrGrow() {
+			lock_guard<mutex> lock( _mutex );
+			if( _idle > 0 ) {
+				_cond.notify_one();
+			}
+			else if( size_t( _running ) < _maxRunning ) {
+				_workers.emplace_back( new Worker() );
+				Worker* worker = _workers.back().get();
+				++_running;
+				thread( bind( &Scheduler::_run, this, worker ) ).detach();
+			}
+		}
+
+		// own tasks in LIFO order, then global ones and the others' in FIFO order.
+		shared_ptr<Task> _find( Worker* self ) {
+			shared_ptr<Task> task;
+			{
+				lock_guard<mutex> lock( self->mutex );
+				if( !self->tasks.empty() ) {
+					task = move( self->tasks.back() );
+					self->tasks.pop_back();
+					return task;
+				}
+			}
+
+			lock_guard<mutex> lock( _mutex );
+			if( !_global.empty() ) {
+				task = move( _global.front() );
+				_global.pop_front();
+				return task;
+			}
+			for( auto const& victim: _workers ) {
+				lock_guard<mutex> vlock( victim->mutex );
+				if( !victim->tasks.empty() ) {
+					task = move( victim->tasks.front() );
+					victim->tasks.pop_front();
+					return task;
+				}
+			}
+			return task;
+		}
+
+		void _run( Worker* self ) {
+			_current() = self;
+			while( true ) {
+				if( shared_ptr<Task> task = _find( self ) ) {
+					--_pending;
+					// the task may have been taken by Task::join().
+					task->tryRun();
+					continue;
+				}
+
+				unique_lock<mutex> lock( _mutex );
+				--_running;
+				++_idle;
+				_cond.wait( lock, [this]() { return _pending > 0; } );
+				--_idle;
+				++_running;
+			}
+		}
+
+		atomic<int>                _running;
+		atomic<int>                _pending;
+		atomic<uint64_t>           _lastId;
+		int                        _idle;
+		size_t                     _maxRunning;
+		vector<unique_ptr<Worker>> _workers;
+		deque<shared_ptr<Task>>    _global;
+		mutex                      _mutex;
+		condition_variable         _cond;
+};
+
+template<class Func0, class Func1>
+tuple<exception_ptr, exception_ptr> parallel( Func0 const& f0, Func1 const& f1 ) {
+	exception_ptr e0, e1;
+
+	auto task = Scheduler::instance().spawn( [&]() -> void {
+		try {
+			f0();
+		}
+		catch( ... ) {
+			e0 = current_exception();
+		}
+	} );
+
+	try {
+		f1();
+	}
+	catch( ... ) {
+		e1 = current_exception();
+	}
+
+	task->join();
+	return make_tuple( move( e0 ), move( e1 ) );
+}
+
+// same as parallel(), but runs the functions as fibers of the current thread.
+template<class Func0, class Func1>
+tuple<exception_ptr, exception_ptr> fiberParallel( Func0 const& f0, Func1 const& f1 ) {
+	exception_ptr e0, e1;
+
+	auto g0 = [&]() -> void {
+		try {
+			f0();
+		}
+		catch( ... ) {
+			e0 = current_exception();
+		}
+	};
+	auto g1 = [&]() -> void {
+		try {
+			f1();
+		}
+		catch( ... ) {
+			e1 = current_exception();
+		}
+	};
+
+	if( FiberLoop* current = FiberLoop::current() ) {
+		auto fiber = current->spawn( g0 );
+		g1();
+		current->join( fiber );
+	}
+	else {
+		FiberLoop loop;
+		loop.spawn( g0 );
+		loop.spawn( g1 );
+		loop.run<Scheduler::Blocking>();
+	}
+	return make_tuple( move( e0 ), move( e1 ) );
+}
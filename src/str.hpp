@@ -0,0 +1,154 @@
+// (c) Yasuhiro Fujii <y-fujii at mimosa-pudica.net> / 2-clause BSD license
+#pragma once
+
+
+// the string commands of "str", which are shared by the builtin of rish and
+// build/str.  they read records by In::get( string& ) and write ones by
+// Out::put( string&& ), and throw invalid_argument on errors.
+// In::terminated() tells whether the last record got had the separator.
+namespace str {
+
+
+template<class In, class Out>
+void chars( vector<string> const&, In& in, Out& out, char sep ) {
+	string buf;
+	while( in.get( buf ) ) {
+		for( char c: buf ) {
+			out.put( string( 1, c ) );
+		}
+		if( in.terminated() ) {
+			out.put( string( 1, sep ) );
+		}
+	}
+}
+
+template<class In, class Out>
+void join( vector<string> const&, In& in, Out& out, char ) {
+	string dst;
+	string buf;
+	while( in.get( buf ) ) {
+		dst += buf;
+	}
+	out.put( move( dst ) );
+}
+
+template<class In, class Out>
+void len( vector<string> const&, In& in, Out& out, char ) {
+	string buf;
+	while( in.get( buf ) ) {
+		out.put( to_string( buf.size() ) );
+	}
+}
+
+template<class In, class Out>
+void index( vector<string> const& args, In& in, Out& out, char ) {
+	vector<int64_t> idx( args.size() );
+	for( size_t i = 0; i < args.size(); ++i ) {
+		idx[i] = strtoll( args[i].c_str(), nullptr, 10 );
+	}
+
+	string buf;
+	while( in.get( buf ) ) {
+		for( int64_t i: idx ) {
+			if( buf.size() == 0 ) {
+				throw invalid_argument( "" );
+			}
+			int64_t j = imod( i, buf.size() );
+			out.put( string( 1, buf[j] ) );
+		}
+	}
+}
+
+template<class In, class Out>
+void slice( vector<string> const& args, In& in, Out& out, char ) {
+	int64_t bgn = strtoll( args[0].c_str(), nullptr, 10 );
+	int64_t end = strtoll( args[1].c_str(), nullptr, 10 );
+
+	string buf;
+	while( in.get( buf ) ) {
+		if( buf.size() == 0 ) {
+			throw invalid_argument( "" );
+		}
+		int64_t b = imod( bgn, buf.size() );
+		int64_t e = imod( end, buf.size() );
+		if( b > e ) {
+			throw invalid_argument( "" );
+		}
+		out.put( buf.substr( b, e - b ) );
+	}
+}
+
+template<class In, class Out>
+void cmp( vector<string> const& args, In& in, Out& out, char ) {
+	string const& src = args[0];
+
+	string buf;
+	while( in.get( buf ) ) {
+		int t = (
+			buf < src ? -1 :
+			buf > src ? +1 :
+			             0
+		);
+		out.put( to_string( t ) );
+	}
+}
+
+template<class In, class Out>
+void match( vector<string> const& args, In& in, Out& out, char ) {
+	Regex re( args[0] );
+	string buf;
+	while( in.get( buf ) ) {
+		if( re.match( buf ) ) {
+			out.put( move( buf ) );
+		}
+	}
+}
+
+template<class In, class Out>
+void subst( vector<string> const& args, In& in, Out& out, char ) {
+	Regex re( args[0] );
+	string buf;
+	while( in.get( buf ) ) {
+		out.put( re.replace( buf, args[1] ) );
+	}
+}
+
+// runs the command args[0] with the rest of args.  sep is the separator of
+// the records, which "chars" writes as a character.
+template<class In, class Out>
+void run( vector<string> const& args, In& in, Out& out, char sep ) {
+	struct Command {
+		char const* name;
+		int arity;
+		void (*func)( vector<string> const&, In&, Out&, char );
+	};
+
+	static Command const commands[] = {
+		{ "chars",  0, &chars<In, Out> },
+		{ "join" ,  0, &join <In, Out> },
+		{ "len"  ,  0, &len  <In, Out> },
+		{ "index", -1, &index<In, Out> },
+		{ "slice",  2, &slice<In, Out> },
+		{ "cmp"  ,  1, &cmp  <In, Out> },
+		{ "match",  1, &match<In, Out> },
+		{ "subst",  2, &subst<In, Out> },
+	};
+
+	if( args.size() == 0 ) {
+		throw invalid_argument( "" );
+	}
+	vector<string> rest( args.begin() + 1, args.end() );
+	for( auto const& e: commands ) {
+		if( args[0] == e.name ) {
+			if( e.arity >= 0 && size_t( e.arity ) != rest.size() ) {
+				throw invalid_argument( "" );
+			}
+			e.func( rest, in, out, sep );
+			return;
+		}
+	}
+	throw invalid_argument( "" );
+}
+
+
+}
@@ -59,6 +59,52 @@ inline int checkSysCall( int retv ) {
 	return retv;
 }
 
+// parks the running fiber, if any, until the file descriptor becomes ready so
+// that the following system call does not block the other fibers.
+inline void waitFd( int fd, short events ) {
+	FiberLoop* loop = FiberLoop::current();
+	if( loop == nullptr ) {
+		return;
+	}
+
+	while( true ) {
+		pollfd pfd{ fd, events, 0 };
+		if( poll( &pfd, 1, 0 ) != 0 ) {
+			return;
+		}
+		loop->waitFd( fd, events );
+		ThreadSupport::checkIntr();
+	}
+}
+
+// same as waitFd(), but waits for the termination of the child process.
+inline void waitExited( pid_t pid ) {
+	FiberLoop* loop = FiberLoop::current();
+	if( loop == nullptr ) {
+		return;
+	}
+
+#if defined( SYS_pidfd_open )
+	int pfd = syscall( SYS_pidfd_open, pid, 0 );
+	if( pfd >= 0 ) {
+		auto closer = scopeExit( bind( close, pfd ) );
+		waitFd( pfd, POLLIN );
+		return;
+	}
+#endif
+
+	while( true ) {
+		siginfo_t info;
+		info.si_pid = 0;
+		if( waitid( P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT ) < 0 || info.si_pid != 0 ) {
+			return;
+		}
+		loop->yield();
+		usleep( 1000 );
+		ThreadSupport::checkIntr();
+	}
+}
+
 template<size_t N>
 struct UnixStreamBuf: streambuf {
 	UnixStreamBuf( int fd ):
@@ -94,6 +140,132 @@ struct UnixIStream: istream {
 		UnixStreamBuf<N> _buf;
 };
 
+// reads a file descriptor in large blocks and splits the data into records.
+// successive readers of the same descriptor must share one instance, because
+// the data read ahead are kept in the buffer.  the block grows up to n bytes
+// while the reads fill it.
+struct RecordReader {
+	RecordReader( RecordReader const& ) = delete;
+	RecordReader& operator=( RecordReader const& ) = delete;
+
+	explicit RecordReader( int fd, size_t n = 1 << 16 ):
+		_fd( fd ), _bgn( 0 ), _end( 0 ), _blockSize( n ), _probed( false ) {
+	}
+
+	// same as getline(), but returns true iff a record is extracted.
+	bool get( string& dst, char sep ) {
+		bool terminated;
+		return get( dst, sep, terminated );
+	}
+
+	// terminated is set to false iff the record is the last one and lacks the
+	// separator.
+	bool get( string& dst, char sep, bool& terminated ) {
+		lock_guard<mutex> lock( _mutex );
+		dst.clear();
+		while( true ) {
+			char const* bgn = _buf.data() + _bgn;
+			if( auto it = static_cast<char const*>( memchr( bgn, sep, _end - _bgn ) ) ) {
+				dst.append( bgn, it );
+				_bgn += it - bgn + 1;
+				terminated = true;
+				return true;
+			}
+			dst.append( bgn, _end - _bgn );
+			_bgn = _end;
+
+			if( !_fill() ) {
+				terminated = false;
+				return !dst.empty();
+			}
+		}
+	}
+
+	int fd() const {
+		return _fd;
+	}
+
+	size_t buffered() {
+		lock_guard<mutex> lock( _mutex );
+		return _end - _bgn;
+	}
+
+	// gives the data read ahead back to the file descriptor and drops them
+	// without copying.  returns false if it is not seekable.
+	bool seekBack() {
+		lock_guard<mutex> lock( _mutex );
+		if( _end > _bgn && lseek( _fd, -off_t( _end - _bgn ), SEEK_CUR ) < 0 ) {
+			return false;
+		}
+		_bgn = _end = 0;
+		return true;
+	}
+
+	// removes the data read ahead from the buffer.
+	string takeBuffered() {
+		lock_guard<mutex> lock( _mutex );
+		string dst( _buf.data() + _bgn, _buf.data() + _end );
+		_bgn = _end = 0;
+		return dst;
+	}
+
+	// pushes the data back to the front of the buffer.
+	void unget( string const& src ) {
+		lock_guard<mutex> lock( _mutex );
+		if( src.size() <= _bgn ) {
+			_bgn -= src.size();
+			copy( src.begin(), src.end(), _buf.begin() + _bgn );
+		}
+		else {
+			string tmp = src;
+			tmp.append( _buf.data() + _bgn, _buf.data() + _end );
+			_buf.assign( tmp.begin(), tmp.end() );
+			_bgn = 0;
+			_end = tmp.size();
+		}
+	}
+
+	private:
+		bool _fill() {
+			// regular files are read ahead by the kernel as a whole.  they are
+			// not mapped, since a file truncated meanwhile would raise SIGBUS.
+			if( !_probed ) {
+				_probed = true;
+				struct stat st;
+				if( fstat( _fd, &st ) == 0 && S_ISREG( st.st_mode ) ) {
+					posix_fadvise( _fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+				}
+			}
+
+			size_t const initial = 1 << 16;
+			if( _buf.size() < min( initial, _blockSize ) ) {
+				_buf.resize( min( initial, _blockSize ) );
+			}
+			else if( _end == _buf.size() && _buf.size() < _blockSize ) {
+				_buf.resize( min( _buf.size() * 2, _blockSize ) );
+			}
+			Scheduler::Blocking blocking;
+			while( true ) {
+				waitFd( _fd, POLLIN );
+				ssize_t n = read( _fd, _buf.data(), _buf.size() );
+				checkSysCall( n );
+				if( n >= 0 ) {
+					_bgn = 0;
+					_end = n;
+					return n > 0;
+				}
+			}
+		}
+
+		int const _fd;
+		vector<char> _buf;
+		size_t _bgn;
+		size_t _end;
+		size_t const _blockSize;
+		bool _probed;
+		mutex _mutex;
+};
+
 #if defined( __linux__ )
 
 #include <sys/syscall.h>
@@ -108,6 +280,13 @@ inline void closefrom_fallback( int lowfd ) {
 inline void closefrom( int lowfd ) {
 	assert( lowfd >= 0 );
 
+#if defined( SYS_close_range )
+	// linux >= 5.9 closes the whole range in one syscall.
+	if( syscall( SYS_close_range, lowfd, ~0u, 0 ) == 0 ) {
+		return;
+	}
+#endif
+
 	// use low-level syscall to make closefrom() async-signal-safe.
 
 	struct linux_dirent {
@@ -200,14 +379,147 @@ inline void closefrom( int lowfd ) {
 #endif
 
 inline void writeAll( int ofd, string const& src ) {
+	Scheduler::Blocking blocking;
+	// a write of PIPE_BUF bytes or less to a writable pipe does not block.
+	size_t n = FiberLoop::current() != nullptr ? PIPE_BUF : src.size();
 	size_t i = 0;
 	while( i < src.size() ) {
-		i += checkSysCall( write( ofd, src.data() + i, src.size() - i ) );
+		waitFd( ofd, POLLOUT );
+		i += checkSysCall( write( ofd, src.data() + i, min( src.size() - i, n ) ) );
 	}
 }
 
+// same as writeAll(), but writes the buffers of iov, which is modified, with
+// writev() so that they need not be joined.
+inline void writeAll( int ofd, iovec* iov, size_t n ) {
+	Scheduler::Blocking blocking;
+	size_t limit = FiberLoop::current() != nullptr ? PIPE_BUF : SIZE_MAX;
+	while( n > 0 ) {
+		size_t m = 0;
+		size_t size = 0;
+		while( m < n && size + iov[m].iov_len <= limit ) {
+			size += iov[m++].iov_len;
+		}
+
+		waitFd( ofd, POLLOUT );
+		size_t r = checkSysCall( m > 0 ?
+			writev( ofd, iov, m ) :
+			write( ofd, iov[0].iov_base, limit )
+		);
+
+		while( n > 0 && r >= iov[0].iov_len ) {
+			r -= iov[0].iov_len;
+			++iov;
+			--n;
+		}
+		if( n > 0 ) {
+			iov[0].iov_base = static_cast<char*>( iov[0].iov_base ) + r;
+			iov[0].iov_len -= r;
+		}
+	}
+}
+
+// a cache of the commands found in PATH, like "hash" of POSIX shells.  an
+// entry is valid while PATH is the same and the directories up to the one
+// which contains the command are not modified, so a hit costs a few stat()s
+// instead of the failing execve()s of execvp().
+struct CommandHash {
+	// returns the name itself if it contains a slash or can not be resolved
+	// here, e.g. because of a relative directory in PATH.  returns an empty
+	// string if the command does not exist.
+	string find( string const& name ) {
+		if( name.empty() || name.find( '/' ) != string::npos ) {
+			return name;
+		}
+
+		char const* path = getenv( "PATH" );
+		if( path == nullptr ) {
+			return name;
+		}
+		lock_guard<mutex> lock( _mutex );
+		if( _path != path ) {
+			_reset( path );
+		}
+
+		auto it = _cache.find( name );
+		if( it != _cache.end() ) {
+			if( _valid( it->second ) ) {
+				return it->second.file;
+			}
+			_cache.erase( it );
+		}
+
+		vector<timespec> mtimes;
+		for( string const& dir: _dirs ) {
+			if( dir.empty() || dir[0] != '/' ) {
+				return name;
+			}
+			mtimes.push_back( _mtime( dir ) );
+			if( mtimes.back().tv_sec < 0 ) {
+				continue;
+			}
+
+			string file = dir + '/' + name;
+			struct stat st;
+			if( stat( file.c_str(), &st ) == 0 && S_ISREG( st.st_mode ) && access( file.c_str(), X_OK ) == 0 ) {
+				_cache[name] = Entry{ file, move( mtimes ) };
+				return file;
+			}
+		}
+		return string();
+	}
+
+	private:
+		// the mtimes of the directories up to the one of the file, when it
+		// was found.
+		struct Entry {
+			string file;
+			vector<timespec> mtimes;
+		};
+
+		void _reset( char const* path ) {
+			_path = path;
+			_cache.clear();
+			_dirs.clear();
+			size_t bgn = 0;
+			while( true ) {
+				size_t end = _path.find( ':', bgn );
+				_dirs.push_back( _path.substr( bgn, end - bgn ) );
+				if( end == string::npos ) {
+					break;
+				}
+				bgn = end + 1;
+			}
+		}
+
+		// a command may be added to the preceding directories, or removed from
+		// its own.
+		bool _valid( Entry const& entry ) {
+			for( size_t i = 0; i < entry.mtimes.size(); ++i ) {
+				timespec mtime = _mtime( _dirs[i] );
+				if( mtime.tv_sec != entry.mtimes[i].tv_sec || mtime.tv_nsec != entry.mtimes[i].tv_nsec ) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static timespec _mtime( string const& dir ) {
+			struct stat st;
+			return stat( dir.c_str(), &st ) == 0 ? st.st_mtim : timespec{ -1, 0 };
+		}
+
+		string _path;
+		vector<string> _dirs;
+		map<string, Entry> _cache;
+		mutex _mutex;
+};
+
+// executes file with the arguments.  file is searched in PATH unless it
+// contains a slash.  returns -1 if the command could not be executed, which
+// corresponds to the exit status 1 of the child.
 template<class Iter>
-pid_t forkExec( Iter argsB, Iter argsE, int ifd, int ofd, string const& cwd ) {
+pid_t forkExec( string const& file, Iter argsB, Iter argsE, int ifd, int ofd, string const& cwd ) {
 	size_t size = distance( argsB, argsE );
 	assert( size >= 1 );
 
@@ -217,6 +529,44 @@ pid_t forkExec( Iter argsB, Iter argsE, int ifd, int ofd, string const& cwd ) {
 	}
 	argsRaw[size] = nullptr;
 
+#if defined( __GLIBC__ ) && __GLIBC_PREREQ( 2, 34 )
+	// glibc spawns with clone( CLONE_VM | CLONE_VFORK ) on a separate stack and
+	// closes the descriptors with close_range(), so the cost of an exec does
+	// not depend on the memory or the descriptors of the shell.
+	posix_spawn_file_actions_t actions;
+	int err = posix_spawn_file_actions_init( &actions );
+	if( err != 0 ) {
+		throw system_error( err, system_category() );
+	}
+	auto destroyer = scopeExit( bind( posix_spawn_file_actions_destroy, &actions ) );
+	if( (err = posix_spawn_file_actions_adddup2( &actions, ifd, 0 )) != 0 ||
+		(err = posix_spawn_file_actions_adddup2( &actions, ofd, 1 )) != 0 ||
+		(err = posix_spawn_file_actions_addclosefrom_np( &actions, 3 )) != 0 ||
+		(err = posix_spawn_file_actions_addchdir_np( &actions, cwd.c_str() )) != 0
+	) {
+		throw system_error( err, system_category() );
+	}
+
+	pid_t pid;
+	auto spawn = file.find( '/' ) != string::npos ? posix_spawn : posix_spawnp;
+	err = spawn(
+		&pid, file.c_str(), &actions, nullptr,
+		const_cast<char* const*>( &argsRaw[0] ), environ
+	);
+	if( err == ENOEXEC ) {
+		// a script without "#!" is run by the shell, as execvp() does.
+		argsRaw.insert( argsRaw.begin(), "/bin/sh" );
+		argsRaw[1] = file.c_str();
+		err = posix_spawn(
+			&pid, "/bin/sh", &actions, nullptr,
+			const_cast<char* const*>( &argsRaw[0] ), environ
+		);
+	}
+	if( err == EAGAIN || err == ENOMEM ) {
+		throw system_error( err, system_category() );
+	}
+	return err == 0 ? pid : -1;
+#else
 	pid_t pid = vfork();
 	checkSysCall( pid );
 	if( pid == 0 ) {
@@ -230,11 +580,12 @@ pid_t forkExec( Iter argsB, Iter argsE, int ifd, int ofd, string const& cwd ) {
 		if( chdir( cwd.c_str() ) < 0 ) {
 			_exit( 1 );
 		}
-		execvp( argsRaw[0], const_cast<char* const*>( &argsRaw[0] ) );
+		execvp( file.c_str(), const_cast<char* const*>( &argsRaw[0] ) );
 		_exit( 1 );
 	}
 
 	return pid;
+#endif
 }
 
 template<class T>
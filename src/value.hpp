@@ -0,0 +1,82 @@
+// (c) Yasuhiro Fujii <y-fujii at mimosa-pudica.net> / 2-clause BSD license
+#pragma once
+
+
+// an element of the lists which rish programs handle.  the results of
+// arithmetic are kept as integers and formatted only when their text is
+// needed, e.g. when they are passed to commands or written to outputs.
+struct Value {
+	Value( MetaString const& s ): _text( s ), _num( 0 ), _isInt( false ) {}
+	Value( MetaString&& s ): _text( move( s ) ), _num( 0 ), _isInt( false ) {}
+	Value( string const& s ): _text( s ), _num( 0 ), _isInt( false ) {}
+	Value( string&& s ): _text( move( s ) ), _num( 0 ), _isInt( false ) {}
+	Value( int64_t n ): _num( n ), _isInt( true ) {}
+
+	bool isInt() const {
+		return _isInt;
+	}
+
+	// same as stoll( str() ), including the exceptions, without copying.
+	int64_t toInt() const {
+		return _isInt ? _num : toInt( _text.str() );
+	}
+
+	static int64_t toInt( string const& text ) {
+		auto it = text.cbegin();
+		auto end = text.cend();
+		while( it != end && isspace( uint8_t( *it ) ) ) {
+			++it;
+		}
+		bool neg = false;
+		if( it != end && (char( *it ) == '+' || char( *it ) == '-') ) {
+			neg = char( *it ) == '-';
+			++it;
+		}
+		if( it == end || !isdigit( uint8_t( *it ) ) ) {
+			throw invalid_argument( "stoll" );
+		}
+
+		uint64_t limit = uint64_t( numeric_limits<int64_t>::max() ) + (neg ? 1 : 0);
+		uint64_t r = 0;
+		for( ; it != end && isdigit( uint8_t( *it ) ); ++it ) {
+			uint64_t d = uint8_t( *it ) - '0';
+			if( r > (limit - d) / 10 ) {
+				throw out_of_range( "stoll" );
+			}
+			r = r * 10 + d;
+		}
+		return neg ? int64_t( -r ) : int64_t( r );
+	}
+
+	MetaString text() const {
+		return _isInt ? MetaString( to_string( _num ) ) : _text;
+	}
+
+	string str() const {
+		return _isInt ? to_string( _num ) : _text.str();
+	}
+
+	// the text with the meta characters; only for non-integers.
+	MetaString const& meta() const {
+		assert( !_isInt );
+		return _text;
+	}
+
+	private:
+		MetaString _text;
+		int64_t _num;
+		bool _isInt;
+};
+
+inline bool operator!=( MetaString const& lhs, Value const& rhs ) {
+	return rhs.isInt() ? lhs != rhs.str() : lhs != rhs.meta();
+}
+
+template<class DstIter>
+DstIter expandGlob( Value const& src, string const& cwd, DirCache& cache, DstIter dstIt ) {
+	if( src.isInt() ) {
+		*dstIt++ = src.str();
+		return dstIt;
+	}
+	return expandGlob( src.meta(), cwd, cache, dstIt );
+}